@@ -0,0 +1,412 @@
+// Benchmarks for graph construction, mutation and shortest paths.
+//
+// Every case runs over the cartesian product of the sizes, densities
+// and cost ranges given on the command line and reports latency
+// percentiles in nanoseconds together with the peak resident set size
+// of the case. Every case runs in a child process of its own so that
+// the peak is the one of the case and not the high-water mark of all
+// the cases before it. Graphs and operation sequences
+// only depend on the seed so two runs with the same arguments do the
+// same work and can be compared release to release.
+//
+// Usage: bench [--sizes 100,200] [--densities 0.01,0.1] [--costs 1:2,0:100]
+//              [--cases generate_graph,add_edge,...] [--samples 1000]
+//              [--repeat 5] [--seed 42] [--format json|csv]
+//
+// Cases: generate_graph, add_edge, has_edge, delete_edge,
+//        shortest_path, get_path
+
+// C++ includes
+#include "graph.hpp"
+#include "shortest_path.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>      // For pair
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdlib>
+#include <sys/resource.h> // For rusage
+#include <sys/wait.h>     // For wait4
+#include <unistd.h>       // For fork, pipe
+
+using namespace std;
+
+struct options
+{
+    vector<size_t> sizes = {100, 200};
+    vector<double> densities = {0.01, 0.1};
+    vector<pair<int, int>> costs = {{1, 2}, {0, 100}};
+    vector<string> cases = {"generate_graph", "add_edge", "has_edge",
+                            "delete_edge", "shortest_path", "get_path"};
+    size_t samples = 1000;
+    size_t repeat = 5;
+    unsigned seed = 42;
+    string format = "json";
+};
+
+struct parameters
+{
+    size_t size;
+    double density;
+    int min_cost;
+    int max_cost;
+    unsigned seed;
+};
+
+struct result
+{
+    string name;
+    parameters param;
+    vector<double> samples; // nanoseconds
+    long peak_rss_kb;
+};
+
+typedef function<void(const options&, const parameters&, result&)> bench;
+
+static double percentile(const vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+// Time a single call in nanoseconds
+template <typename F>
+static double measure(F f)
+{
+    auto start = chrono::steady_clock::now();
+    f();
+    auto stop = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(stop - start).count();
+}
+
+static vector<graph::node*> node_vector(graph& g)
+{
+    vector<graph::node*> nodes;
+    for (auto& n: g.get_nodes()) {
+        nodes.push_back(n.get());
+    }
+    return nodes;
+}
+
+static graph::graph_ptr make_graph(const parameters& p)
+{
+    return graph::generate_graph(p.size, p.density, p.min_cost, p.max_cost, p.seed);
+}
+
+static void bench_generate_graph(const options& o, const parameters& p, result& r)
+{
+    for (size_t i = 0; i < o.repeat; ++i) {
+        r.samples.push_back(measure([&]() {make_graph(p);}));
+    }
+}
+
+static void bench_add_edge(const options& o, const parameters& p, result& r)
+{
+    auto g = make_graph(p);
+    auto nodes = node_vector(*g);
+    mt19937 rng(p.seed);
+    uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+    uniform_int_distribution<int> cost(p.min_cost, max(p.min_cost, p.max_cost - 1));
+    if (nodes.size() < 2) {
+        return;
+    }
+    for (size_t i = 0; i < o.samples; ++i) {
+        size_t ix = pick(rng);
+        size_t iy = pick(rng);
+        // Self loops are not what we want to time
+        while (iy == ix) {
+            iy = pick(rng);
+        }
+        auto& x = *nodes[ix];
+        auto& y = *nodes[iy];
+        int c = cost(rng);
+        r.samples.push_back(measure([&]() {g->add_edge(x, y, c);}));
+    }
+}
+
+static void bench_has_edge(const options& o, const parameters& p, result& r)
+{
+    auto g = make_graph(p);
+    auto nodes = node_vector(*g);
+    mt19937 rng(p.seed);
+    uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+    volatile bool found = false;
+    for (size_t i = 0; i < o.samples; ++i) {
+        auto& x = *nodes[pick(rng)];
+        auto& y = *nodes[pick(rng)];
+        r.samples.push_back(measure([&]() {found = g->has_edge(x, y);}));
+    }
+}
+
+static void bench_delete_edge(const options& o, const parameters& p, result& r)
+{
+    auto g = make_graph(p);
+    vector<pair<graph::node*, graph::node*>> edges;
+    for (auto& e: g->get_edges()) {
+        auto& ends = e->get_edge();
+        edges.push_back({&ends.first.get(), &ends.second.get()});
+    }
+    shuffle(edges.begin(), edges.end(), mt19937(p.seed));
+    if (edges.size() > o.samples) {
+        edges.resize(o.samples);
+    }
+    for (auto& e: edges) {
+        r.samples.push_back(measure([&]() {g->delete_edge(*e.first, *e.second);}));
+    }
+}
+
+static void bench_shortest_path(const options& o, const parameters& p, result& r)
+{
+    auto g = make_graph(p);
+    for (size_t i = 0; i < o.repeat; ++i) {
+        r.samples.push_back(measure([&]() {shortest_path s(*g);}));
+    }
+}
+
+static void bench_get_path(const options& o, const parameters& p, result& r)
+{
+    auto g = make_graph(p);
+    auto nodes = node_vector(*g);
+    shortest_path s(*g);
+    mt19937 rng(p.seed);
+    uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+    path* volatile found = nullptr;
+    for (size_t i = 0; i < o.samples; ++i) {
+        auto& x = *nodes[pick(rng)];
+        auto& y = *nodes[pick(rng)];
+        r.samples.push_back(measure([&]() {found = s.get_path(x, y);}));
+    }
+}
+
+static bool write_all(int fd, const void* data, size_t size)
+{
+    auto p = static_cast<const char*>(data);
+    while (size) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void* data, size_t size)
+{
+    auto p = static_cast<char*>(data);
+    while (size) {
+        ssize_t n = read(fd, p, size);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Run the case in a child, the samples come back over a pipe and the
+// peak resident set size from wait4
+static bool run_case(const bench& b, const options& o, result& r)
+{
+    int fds[2];
+    if (pipe(fds) < 0) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        b(o, r.param, r);
+        size_t count = r.samples.size();
+        bool sent = write_all(fds[1], &count, sizeof(count))
+                    && write_all(fds[1], r.samples.data(), count * sizeof(double));
+        close(fds[1]);
+        _exit(sent ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(fds[1]);
+    size_t count = 0;
+    bool received = read_all(fds[0], &count, sizeof(count));
+    if (received) {
+        r.samples.resize(count);
+        received = read_all(fds[0], r.samples.data(), count * sizeof(double));
+    }
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        return false;
+    }
+    r.peak_rss_kb = usage.ru_maxrss; // Kilobytes on Linux
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+template <typename T, typename Parse>
+static vector<T> parse_list(const string& arg, Parse parse)
+{
+    vector<T> values;
+    stringstream in(arg);
+    string item;
+    while (getline(in, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(parse(item));
+        }
+    }
+    return values;
+}
+
+static bool parse_options(int ac, char** av, options& o)
+{
+    for (int i = 1; i < ac; ++i) {
+        string flag = av[i];
+        if (i + 1 >= ac) {
+            cerr << "Missing value for " << flag << endl;
+            return false;
+        }
+        string value = av[++i];
+        if (flag == "--sizes") {
+            o.sizes = parse_list<size_t>(value, [](const string& s) {return stoul(s);});
+        } else if (flag == "--densities") {
+            o.densities = parse_list<double>(value, [](const string& s) {return stod(s);});
+        } else if (flag == "--costs") {
+            o.costs = parse_list<pair<int, int>>(value, [](const string& s)
+            {
+                auto colon = s.find(':');
+                return make_pair(stoi(s.substr(0, colon)), stoi(s.substr(colon + 1)));
+            });
+        } else if (flag == "--cases") {
+            o.cases = parse_list<string>(value, [](const string& s) {return s;});
+        } else if (flag == "--samples") {
+            o.samples = stoul(value);
+        } else if (flag == "--repeat") {
+            o.repeat = stoul(value);
+        } else if (flag == "--seed") {
+            o.seed = stoul(value);
+        } else if (flag == "--format") {
+            o.format = value;
+        } else {
+            cerr << "Unknown option " << flag << endl;
+            return false;
+        }
+    }
+    return o.format == "json" || o.format == "csv";
+}
+
+static void print_csv(ostream& out, const vector<result>& results)
+{
+    out << "case,size,density,min_cost,max_cost,seed,samples,"
+        << "mean_ns,p50_ns,p90_ns,p99_ns,max_ns,peak_rss_kb" << endl;
+    for (auto& r: results) {
+        auto sorted = r.samples;
+        sort(sorted.begin(), sorted.end());
+        double mean = 0.0;
+        for (auto s: sorted) {
+            mean += s / sorted.size();
+        }
+        out << r.name << ',' << r.param.size << ',' << r.param.density << ','
+            << r.param.min_cost << ',' << r.param.max_cost << ',' << r.param.seed << ','
+            << sorted.size() << ',' << mean << ','
+            << percentile(sorted, 0.5) << ',' << percentile(sorted, 0.9) << ','
+            << percentile(sorted, 0.99) << ',' << percentile(sorted, 1.0) << ','
+            << r.peak_rss_kb << endl;
+    }
+}
+
+static void print_json(ostream& out, const vector<result>& results)
+{
+    out << "[" << endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto& r = results[i];
+        auto sorted = r.samples;
+        sort(sorted.begin(), sorted.end());
+        double mean = 0.0;
+        for (auto s: sorted) {
+            mean += s / sorted.size();
+        }
+        out << "  {\"case\": \"" << r.name << "\""
+            << ", \"size\": " << r.param.size
+            << ", \"density\": " << r.param.density
+            << ", \"min_cost\": " << r.param.min_cost
+            << ", \"max_cost\": " << r.param.max_cost
+            << ", \"seed\": " << r.param.seed
+            << ", \"samples\": " << sorted.size()
+            << ", \"unit\": \"ns\""
+            << ", \"mean\": " << mean
+            << ", \"p50\": " << percentile(sorted, 0.5)
+            << ", \"p90\": " << percentile(sorted, 0.9)
+            << ", \"p99\": " << percentile(sorted, 0.99)
+            << ", \"max\": " << percentile(sorted, 1.0)
+            << ", \"peak_rss_kb\": " << r.peak_rss_kb
+            << "}" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    out << "]" << endl;
+}
+
+int main(int ac, char** av)
+{
+    options o;
+    if (!parse_options(ac, av, o)) {
+        cerr << "Usage: " << av[0] << " [--sizes n,...] [--densities d,...]"
+             << " [--costs min:max,...] [--cases name,...] [--samples n]"
+             << " [--repeat n] [--seed n] [--format json|csv]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    vector<pair<string, bench>> all = {
+        {"generate_graph", bench_generate_graph},
+        {"add_edge", bench_add_edge},
+        {"has_edge", bench_has_edge},
+        {"delete_edge", bench_delete_edge},
+        {"shortest_path", bench_shortest_path},
+        {"get_path", bench_get_path},
+    };
+
+    vector<result> results;
+    for (auto& name: o.cases) {
+        auto b = find_if(all.begin(), all.end(),
+                         [&](const pair<string, bench>& i) {return i.first == name;});
+        if (b == all.end()) {
+            cerr << "Unknown case " << name << endl;
+            return EXIT_FAILURE;
+        }
+        for (auto size: o.sizes) {
+            for (auto density: o.densities) {
+                for (auto& cost: o.costs) {
+                    if (!size) {
+                        continue;
+                    }
+                    result r;
+                    r.name = name;
+                    r.param = {size, density, cost.first, cost.second, o.seed};
+                    if (!run_case(b->second, o, r)) {
+                        cerr << "Case " << name << " failed" << endl;
+                        return EXIT_FAILURE;
+                    }
+                    results.push_back(move(r));
+                }
+            }
+        }
+    }
+
+    if (o.format == "csv") {
+        print_csv(cout, results);
+    } else {
+        print_json(cout, results);
+    }
+    return EXIT_SUCCESS;
+}
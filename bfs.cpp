@@ -0,0 +1,231 @@
+#include "bfs.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+
+using namespace std;
+
+template <typename Adjacency>
+const size_t basic_bfs<Adjacency>::unreached;
+template <typename Adjacency>
+const csr::index basic_bfs<Adjacency>::none;
+
+// Threads below this many bitmap words (64 nodes each) are not worth it
+static const size_t word_grain = 16;
+
+static inline uint64_t bit(size_t i)
+{
+    return static_cast<uint64_t>(1) << (i % 64);
+}
+
+template <typename Adjacency>
+basic_bfs<Adjacency>::basic_bfs(const Adjacency& c, size_t threads, size_t alpha, size_t beta)
+    : _c(c),
+      _threads(threads ? threads : default_threads()),
+      _alpha(alpha ? alpha : 1),
+      _beta(beta ? beta : 1),
+      _words((c.node_count() + 63) / 64),
+      _parent(c.node_count()),
+      _depth(c.node_count(), none),
+      _frontier(_words),
+      _next(_words),
+      _order(),
+      _top_down_steps(0),
+      _bottom_up_steps(0)
+{
+    STATS_ADD(bytes_allocated, c.node_count() * 2 * sizeof(csr::index)
+                               + _words * 2 * sizeof(uint64_t));
+}
+
+template <typename Adjacency>
+void basic_bfs<Adjacency>::run(size_t source)
+{
+    for (auto& p: _parent) {
+        p.store(none, memory_order_relaxed);
+    }
+    for (auto& w: _frontier) {
+        w.store(0, memory_order_relaxed);
+    }
+    _order.clear();
+    _top_down_steps = 0;
+    _bottom_up_steps = 0;
+    if (source >= _c.node_count()) {
+        return;
+    }
+
+    _parent[source].store(static_cast<csr::index>(source), memory_order_relaxed);
+    _depth[source] = 0;
+    _frontier[source / 64].store(bit(source), memory_order_relaxed);
+    _order.push_back(source);
+    STATS_ADD(nodes_settled, 1);
+    STATS_MAX(peak_threads, _threads);
+
+    size_t frontier_nodes = 1;
+    size_t frontier_edges = _c.degree(source);
+    size_t unexplored_edges = _c.arc_count() - frontier_edges;
+    bool bottom = false;
+    for (size_t level = 0; frontier_nodes; ++level) {
+        if (!bottom && frontier_edges > unexplored_edges / _alpha) {
+            bottom = true;
+        } else if (bottom && frontier_nodes < _c.node_count() / _beta) {
+            bottom = false;
+        }
+        for (auto& w: _next) {
+            w.store(0, memory_order_relaxed);
+        }
+        size_t scout = 0;
+        if (bottom) {
+            frontier_nodes = bottom_up(level, scout);
+            ++_bottom_up_steps;
+        } else {
+            frontier_nodes = top_down(level, scout);
+            ++_top_down_steps;
+        }
+        STATS_ADD(nodes_settled, frontier_nodes);
+        STATS_MAX(peak_open_set, frontier_nodes);
+        frontier_edges = scout;
+        unexplored_edges -= (scout < unexplored_edges) ? scout : unexplored_edges;
+        collect_next();
+    }
+}
+
+template <typename Adjacency>
+size_t basic_bfs<Adjacency>::top_down(size_t level, size_t& scout)
+{
+    atomic<size_t> found(0);
+    atomic<size_t> scouted(0);
+#ifdef SHORTEST_PATH_STATS
+    atomic<size_t> relaxed(0);
+#endif
+    auto depth = static_cast<csr::index>(level + 1);
+    parallel_for(0, _words, _threads, [&](size_t lo, size_t hi)
+    {
+        size_t f = 0;
+        size_t s = 0;
+#ifdef SHORTEST_PATH_STATS
+        size_t r = 0;
+#endif
+        for (size_t w = lo; w < hi; ++w) {
+            uint64_t bits = _frontier[w].load(memory_order_relaxed);
+            while (bits) {
+                size_t v = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                for (auto a: _c.arcs(v)) {
+                    csr::index t = a.target;
+#ifdef SHORTEST_PATH_STATS
+                    ++r;
+#endif
+                    if (_parent[t].load(memory_order_relaxed) != none) {
+                        continue;
+                    }
+                    // Several frontier nodes may race for the same
+                    // neighbor, only the first one becomes its parent
+                    csr::index expected = none;
+                    if (_parent[t].compare_exchange_strong(expected,
+                                                           static_cast<csr::index>(v),
+                                                           memory_order_relaxed)) {
+                        _depth[t] = depth;
+                        _next[t / 64].fetch_or(bit(t), memory_order_relaxed);
+                        ++f;
+                        s += _c.degree(t);
+                    }
+                }
+            }
+        }
+        found += f;
+        scouted += s;
+#ifdef SHORTEST_PATH_STATS
+        relaxed += r;
+#endif
+    }, word_grain);
+    // The worker threads are gone, account from the calling thread
+    STATS_ADD(edges_relaxed, relaxed);
+    scout = scouted;
+    return found;
+}
+
+template <typename Adjacency>
+size_t basic_bfs<Adjacency>::bottom_up(size_t level, size_t& scout)
+{
+    atomic<size_t> found(0);
+    atomic<size_t> scouted(0);
+#ifdef SHORTEST_PATH_STATS
+    atomic<size_t> relaxed(0);
+#endif
+    auto depth = static_cast<csr::index>(level + 1);
+    size_t n = _c.node_count();
+    parallel_for(0, _words, _threads, [&](size_t lo, size_t hi)
+    {
+        size_t f = 0;
+        size_t s = 0;
+#ifdef SHORTEST_PATH_STATS
+        size_t r = 0;
+#endif
+        for (size_t w = lo; w < hi; ++w) {
+            // Each thread owns whole words of the next frontier
+            // so it can build them locally and store them once
+            uint64_t word = 0;
+            size_t end = (w + 1) * 64 < n ? (w + 1) * 64 : n;
+            for (size_t v = w * 64; v < end; ++v) {
+                if (_parent[v].load(memory_order_relaxed) != none) {
+                    continue;
+                }
+                for (auto a: _c.arcs(v)) {
+                    csr::index t = a.target;
+#ifdef SHORTEST_PATH_STATS
+                    ++r;
+#endif
+                    if (_frontier[t / 64].load(memory_order_relaxed) & bit(t)) {
+                        _parent[v].store(t, memory_order_relaxed);
+                        _depth[v] = depth;
+                        word |= bit(v);
+                        ++f;
+                        s += _c.degree(v);
+                        break;
+                    }
+                }
+            }
+            _next[w].store(word, memory_order_relaxed);
+        }
+        found += f;
+        scouted += s;
+#ifdef SHORTEST_PATH_STATS
+        relaxed += r;
+#endif
+    }, word_grain);
+    // The worker threads are gone, account from the calling thread
+    STATS_ADD(edges_relaxed, relaxed);
+    scout = scouted;
+    return found;
+}
+
+template <typename Adjacency>
+void basic_bfs<Adjacency>::collect_next()
+{
+    for (size_t w = 0; w < _words; ++w) {
+        uint64_t bits = _next[w].load(memory_order_relaxed);
+        while (bits) {
+            _order.push_back(w * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+    _frontier.swap(_next);
+}
+
+template <typename Adjacency>
+size_t basic_bfs<Adjacency>::get_parent(size_t i) const
+{
+    csr::index p = _parent[i].load(memory_order_relaxed);
+    return p == none ? unreached : p;
+}
+
+template <typename Adjacency>
+size_t basic_bfs<Adjacency>::get_depth(size_t i) const
+{
+    if (get_parent(i) == unreached) {
+        return unreached;
+    }
+    return _depth[i];
+}
+
+template class basic_bfs<csr>;
+template class basic_bfs<compressed_csr>;
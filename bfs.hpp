@@ -0,0 +1,74 @@
+#ifndef __BFS__
+#define __BFS__
+
+// C++ includes
+#include "compressed_csr.hpp"
+#include "csr.hpp"
+#include <atomic>
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint64_t
+
+// Direction optimizing breadth first search (Beamer, Asanovic, Patterson).
+//
+// When all the edges have the same cost the shortest path tree is the
+// BFS tree so there is no need for a priority queue at all. Frontiers
+// are bitmaps over the csr indices. A level is expanded either top down
+// (every frontier node claims its unvisited neighbors) or bottom up
+// (every unvisited node looks for a parent in the frontier), whichever
+// touches fewer edges:
+//  - switch to bottom up when the edges out of the frontier exceed
+//    the edges left to explore divided by alpha
+//  - switch back to top down when the frontier drops under the node
+//    count divided by beta
+// Both directions split the bitmap words between threads. The engine
+// keeps its buffers between runs so one instance can serve every source.
+// basic_bfs<compressed_csr> runs on the compressed snapshot.
+template <typename Adjacency>
+class basic_bfs
+{
+    public:
+        static const size_t unreached = static_cast<size_t>(-1);
+
+        explicit basic_bfs(const Adjacency& c, size_t threads = 0,
+                           size_t alpha = 14, size_t beta = 24);
+        basic_bfs(const basic_bfs&) = delete;
+        basic_bfs& operator=(const basic_bfs&) = delete;
+
+        void run(size_t source);
+        size_t get_parent(size_t i) const;
+        size_t get_depth(size_t i) const;
+        // Reached nodes level by level, the source first
+        const std::vector<size_t>& get_order() const {return _order;}
+        size_t top_down_steps() const {return _top_down_steps;}
+        size_t bottom_up_steps() const {return _bottom_up_steps;}
+    private:
+        typedef std::vector<std::atomic<uint64_t>> bitmap;
+        static const csr::index none = static_cast<csr::index>(-1);
+
+        size_t top_down(size_t level, size_t& scout);
+        size_t bottom_up(size_t level, size_t& scout);
+        void collect_next();
+
+        const Adjacency& _c;
+        size_t _threads;
+        size_t _alpha;
+        size_t _beta;
+        size_t _words;
+        std::vector<std::atomic<csr::index>> _parent;
+        std::vector<csr::index> _depth;
+        bitmap _frontier;
+        bitmap _next;
+        std::vector<size_t> _order;
+        size_t _top_down_steps;
+        size_t _bottom_up_steps;
+};
+
+// Both are compiled once in bfs.cpp
+extern template class basic_bfs<csr>;
+extern template class basic_bfs<compressed_csr>;
+typedef basic_bfs<csr> bfs;
+
+#endif // __BFS__
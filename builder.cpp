@@ -0,0 +1,138 @@
+#include "builder.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <cstdint>      // For uint32_t
+
+using namespace std;
+
+graph_builder::graph_builder(size_t shards)
+    : _id(0),
+      _mask(0),
+      _shards()
+{
+    if (!shards) {
+        shards = 4 * default_threads();
+    }
+    // Round up to a power of two so that picking a shard is a mask
+    size_t count = 1;
+    while (count < shards) {
+        count <<= 1;
+    }
+    _mask = count - 1;
+    _shards.reset(new shard[count]);
+}
+
+graph_builder::shard& graph_builder::get_shard(int id)
+{
+    // Fibonacci hashing spreads consecutive ids over all the shards
+    uint32_t h = static_cast<uint32_t>(id) * 2654435769u;
+    return _shards[(h >> 16) & _mask];
+}
+
+int graph_builder::add_node()
+{
+    int id = _id.fetch_add(1, memory_order_relaxed);
+    auto& s = get_shard(id);
+    lock_guard<mutex> lock(s.lock);
+    s.nodes.push_back(id);
+    return id;
+}
+
+void graph_builder::add_node(int id)
+{
+    // Keep the generated ids clear of the explicit ones
+    int current = _id.load(memory_order_relaxed);
+    while (current <= id &&
+           !_id.compare_exchange_weak(current, id + 1, memory_order_relaxed)) {
+    }
+    auto& s = get_shard(id);
+    lock_guard<mutex> lock(s.lock);
+    s.nodes.push_back(id);
+}
+
+void graph_builder::add_edge(int x, int y, int cost)
+{
+    auto& s = get_shard(x);
+    lock_guard<mutex> lock(s.lock);
+    s.edges.push_back({x, y, cost});
+}
+
+size_t graph_builder::node_count()
+{
+    size_t count = 0;
+    for (size_t i = 0; i <= _mask; ++i) {
+        lock_guard<mutex> lock(_shards[i].lock);
+        count += _shards[i].nodes.size();
+    }
+    return count;
+}
+
+size_t graph_builder::edge_count()
+{
+    size_t count = 0;
+    for (size_t i = 0; i <= _mask; ++i) {
+        lock_guard<mutex> lock(_shards[i].lock);
+        count += _shards[i].edges.size();
+    }
+    return count;
+}
+
+graph::graph_ptr graph_builder::seal()
+{
+    TRACE_SPAN("seal");
+    // Take everything out of the shards, producers that keep going
+    // simply start filling the next graph
+    vector<vector<int>> shard_nodes(_mask + 1);
+    vector<vector<record>> edges(_mask + 1);
+    for (size_t i = 0; i <= _mask; ++i) {
+        lock_guard<mutex> lock(_shards[i].lock);
+        shard_nodes[i].swap(_shards[i].nodes);
+        edges[i].swap(_shards[i].edges);
+    }
+    vector<int> ids;
+    for (auto& n: shard_nodes) {
+        ids.insert(ids.end(), n.begin(), n.end());
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+
+    // Check the whole batch before building anything. When an edge is
+    // wrong everything goes back to the shards, on top of whatever was
+    // added in the meantime, so that the caller can add the missing
+    // node and seal again.
+    auto known = [&](int id) {return binary_search(ids.begin(), ids.end(), id);};
+    for (auto& shard_edges: edges) {
+        for (auto& e: shard_edges) {
+            if (known(e.x) && known(e.y)) {
+                continue;
+            }
+            for (size_t i = 0; i <= _mask; ++i) {
+                lock_guard<mutex> lock(_shards[i].lock);
+                auto& s = _shards[i];
+                s.nodes.insert(s.nodes.end(), shard_nodes[i].begin(), shard_nodes[i].end());
+                s.edges.insert(s.edges.end(), edges[i].begin(), edges[i].end());
+            }
+            throw runtime_error("Edge refers to an unknown node");
+        }
+    }
+
+    auto g = graph::graph_ptr(new graph);
+    unordered_map<int, graph::node*> nodes;
+    nodes.reserve(ids.size());
+    for (auto id: ids) {
+        nodes.insert({id, &g->add_node(id)});
+    }
+    for (auto& shard_edges: edges) {
+        for (auto& e: shard_edges) {
+            // Both nodes come from g, no need for add_edge to look them up
+            g->link(*nodes[e.x], *nodes[e.y], e.cost);
+        }
+    }
+    g->_id = _id.load();
+    return g;
+}
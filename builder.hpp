@@ -0,0 +1,64 @@
+#ifndef __BUILDER__
+#define __BUILDER__
+
+// C++ includes
+#include "graph.hpp"
+#include <atomic>
+#include <memory>       // For unique_ptr
+#include <mutex>
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Concurrent ingest front end for graph.
+//
+// graph itself is single threaded: the counters, the id generator and
+// the lists are plain members. Producers instead feed a graph_builder
+// from as many threads as they like and call seal() once at the end to
+// get a normal graph. Node ids come from an atomic counter. Nodes and
+// edges are appended to shards picked by hashing the (first) node id,
+// each shard behind its own mutex, so producers only contend when they
+// hit the same shard at the same time. Nodes are only ids until seal()
+// so edges refer to them by id.
+class graph_builder
+{
+    public:
+        // 0 shards picks a count from the number of hardware threads
+        explicit graph_builder(size_t shards = 0);
+        graph_builder(const graph_builder&) = delete;
+        graph_builder& operator=(const graph_builder&) = delete;
+
+        int add_node();
+        void add_node(int id);
+        void add_edge(int x, int y, int cost = 0);
+        size_t node_count();
+        size_t edge_count();
+        size_t shard_count() const {return _mask + 1;}
+        // Builds the graph from everything added so far and leaves the
+        // builder empty. Nodes are created in increasing id order.
+        // Throws runtime_error when an edge names an unknown node, the
+        // builder then keeps everything it had.
+        graph::graph_ptr seal();
+    private:
+        struct record
+        {
+            int x;
+            int y;
+            int cost;
+        };
+        struct shard
+        {
+            std::mutex lock;
+            std::vector<int> nodes;
+            std::vector<record> edges;
+            // Keeps the locks of neighbor shards on different cache lines
+            char padding[64];
+        };
+        shard& get_shard(int id);
+        std::atomic<int> _id;
+        size_t _mask;
+        std::unique_ptr<shard[]> _shards;
+};
+
+#endif // __BUILDER__
@@ -0,0 +1,167 @@
+#include "centrality.hpp"
+#include "csr.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Buffers of a single source search, reused from one source to the
+// next by the thread that owns them
+class brandes
+{
+    public:
+        explicit brandes(const csr& c)
+            : _c(c),
+              _distance(c.node_count(), infinity),
+              _rank(c.node_count(), unreached),
+              _paths(c.node_count(), 0.0),
+              _dependency(c.node_count(), 0.0),
+              _open(),
+              _order()
+        {
+            STATS_ADD(bytes_allocated, c.node_count() * (sizeof(int) + sizeof(size_t)
+                                                         + 2 * sizeof(double)));
+        }
+        // Adds the dependencies of source to centrality
+        void run(size_t source, vector<double>& centrality);
+    private:
+        static const size_t unreached = static_cast<size_t>(-1);
+        static const int infinity = numeric_limits<int>::max();
+        typedef pair<int, size_t> entry;
+        struct open_set_order
+        {
+            bool operator()(const entry& e1, const entry& e2) const
+            {
+                return e1.first > e2.first;
+            }
+        };
+        // v comes right before w on a shortest path. Looking at the
+        // settle order rather than just the distances keeps zero cost
+        // edges from making both ends the predecessor of the other.
+        bool precedes(size_t v, size_t w, int cost) const
+        {
+            return _rank[v] < _rank[w] && _distance[v] + cost == _distance[w];
+        }
+        const csr& _c;
+        vector<int> _distance;
+        // Position in _order once settled, unreached before
+        vector<size_t> _rank;
+        // Number of shortest paths from the source, as a double since
+        // it grows exponentially on grid like graphs
+        vector<double> _paths;
+        vector<double> _dependency;
+        vector<entry> _open;
+        vector<size_t> _order;
+};
+
+const size_t brandes::unreached;
+const int brandes::infinity;
+
+void brandes::run(size_t source, vector<double>& centrality)
+{
+    // Without an early stop every node reached is settled so the
+    // previous order covers everything to reset
+    for (auto i: _order) {
+        _distance[i] = infinity;
+        _rank[i] = unreached;
+        _dependency[i] = 0.0;
+    }
+    _order.clear();
+    _open.clear();
+    _distance[source] = 0;
+    _open.push_back({0, source});
+    while (!_open.empty()) {
+        pop_heap(_open.begin(), _open.end(), open_set_order());
+        entry current = _open.back();
+        _open.pop_back();
+        size_t w = current.second;
+        if (_rank[w] != unreached || current.first != _distance[w]) {
+            continue; // Stale entry
+        }
+        _rank[w] = _order.size();
+        _order.push_back(w);
+        STATS_ADD(nodes_settled, 1);
+        // Every predecessor is settled by now so the count is final
+        _paths[w] = (w == source) ? 1.0 : 0.0;
+        for (size_t a = _c.arc_begin(w); a < _c.arc_end(w); ++a) {
+            size_t v = _c.target(a);
+            STATS_ADD(edges_relaxed, 1);
+            if (_rank[v] != unreached) {
+                if (precedes(v, w, _c.cost(a))) {
+                    _paths[w] += _paths[v];
+                }
+                continue;
+            }
+            int d = current.first + _c.cost(a);
+            if (d < _distance[v]) {
+                _distance[v] = d;
+                _open.push_back({d, v});
+                push_heap(_open.begin(), _open.end(), open_set_order());
+            }
+        }
+    }
+    // Farthest first, a node passes its dependency on to its
+    // predecessors once all its successors are done with it
+    for (size_t k = _order.size(); k-- > 0;) {
+        size_t w = _order[k];
+        for (size_t a = _c.arc_begin(w); a < _c.arc_end(w); ++a) {
+            size_t v = _c.target(a);
+            if (_rank[v] != unreached && precedes(v, w, _c.cost(a))) {
+                _dependency[v] += _paths[v] / _paths[w] * (1.0 + _dependency[w]);
+            }
+        }
+        if (w != source) {
+            centrality[w] += _dependency[w];
+        }
+    }
+}
+
+}
+
+unordered_map<int, double> betweenness_centrality(graph& g, size_t pivots,
+                                                  unsigned seed, size_t threads)
+{
+    csr c(g);
+    if (c.min_cost() < 0) {
+        throw runtime_error("Betweenness centrality needs non negative costs");
+    }
+    vector<size_t> sources(c.node_count());
+    for (size_t i = 0; i < sources.size(); ++i) {
+        sources[i] = i;
+    }
+    double scale = 0.5;
+    if (pivots && pivots < sources.size()) {
+        shuffle(sources.begin(), sources.end(), mt19937(seed));
+        sources.resize(pivots);
+        scale *= static_cast<double>(c.node_count()) / pivots;
+    }
+    vector<double> centrality(c.node_count(), 0.0);
+    mutex lock;
+    parallel_for(0, sources.size(), threads, [&](size_t lo, size_t hi)
+    {
+        brandes search(c);
+        vector<double> local(c.node_count(), 0.0);
+        for (size_t s = lo; s < hi; ++s) {
+            search.run(sources[s], local);
+        }
+        lock_guard<mutex> guard(lock);
+        for (size_t i = 0; i < local.size(); ++i) {
+            centrality[i] += local[i];
+        }
+    }, 16);
+    unordered_map<int, double> result;
+    for (size_t i = 0; i < c.node_count(); ++i) {
+        result[c.get_id(i)] = centrality[i] * scale;
+    }
+    return result;
+}
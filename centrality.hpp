@@ -0,0 +1,34 @@
+#ifndef __CENTRALITY__
+#define __CENTRALITY__
+
+// C++ includes
+#include "graph.hpp"
+#include <unordered_map>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Betweenness centrality of every node by node id (Brandes).
+//
+// The betweenness of v sums, over every pair of other nodes, the share
+// of their shortest paths going through v. Brandes gets it from one
+// search per source: the search counts the shortest paths to every
+// node and walking the nodes back from the farthest one pushes the
+// dependencies onto the predecessors. A source only needs O(V + E)
+// state so nothing close to the tables of shortest_path is ever
+// stored. Sources are split between threads, each adding into its own
+// accumulator, and the accumulators are summed at the end. Since the
+// edges go both ways every pair is seen from both ends and the result
+// is halved.
+//
+// With pivots the search only runs from that many sources picked at
+// random with seed and the sums are scaled by node_count / pivots,
+// which gives an unbiased estimate. 0 (or more pivots than nodes) is
+// the exact computation. Costs must be non negative, runtime_error
+// otherwise.
+std::unordered_map<int, double> betweenness_centrality(graph& g,
+                                                       size_t pivots = 0,
+                                                       unsigned seed = 0,
+                                                       size_t threads = 0);
+
+#endif // __CENTRALITY__
@@ -0,0 +1,144 @@
+#include "compressed_csr.hpp"
+
+#include <algorithm>
+
+// C includes
+#include <cstdint>      // For uint32_t, uint64_t
+
+using namespace std;
+
+static void put_varint(vector<uint8_t>& data, uint64_t value)
+{
+    while (value >= 0x80) {
+        data.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+static inline uint64_t get_varint(const uint8_t*& data)
+{
+    if (!(*data & 0x80)) {
+        return *data++; // Most gaps after a reorder
+    }
+    uint64_t value = *data & 0x7f;
+    unsigned shift = 7;
+    while (*data++ & 0x80) {
+        value |= static_cast<uint64_t>(*data & 0x7f) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+compressed_csr::arc_iterator::arc_iterator(const uint8_t* data, size_t left, index from,
+                                           unsigned width, int base)
+    : _data(data),
+      _left(left),
+      _width(width),
+      _base(base),
+      _first(true),
+      _arc({from, base})
+{
+    if (_left) {
+        decode();
+    }
+}
+
+void compressed_csr::arc_iterator::decode()
+{
+    uint64_t gap = get_varint(_data);
+    if (_first) {
+        // Zigzag, the first neighbor may come before the node
+        int64_t delta = static_cast<int64_t>(gap >> 1) ^ -static_cast<int64_t>(gap & 1);
+        _arc.target = static_cast<index>(_arc.target + delta);
+        _first = false;
+    } else {
+        _arc.target += static_cast<index>(gap);
+    }
+    uint32_t cost = 0;
+    for (unsigned b = 0; b < _width; ++b) {
+        cost |= static_cast<uint32_t>(*_data++) << (8 * b);
+    }
+    _arc.cost = static_cast<int>(static_cast<uint32_t>(_base) + cost);
+}
+
+compressed_csr::compressed_csr(graph& g)
+    : compressed_csr(csr(g))
+{
+}
+
+compressed_csr::compressed_csr(const csr& c)
+    : _data(),
+      _offsets(),
+      _ids(),
+      _index(),
+      _arc_count(c.arc_count()),
+      _width(0),
+      _min_cost(c.min_cost()),
+      _max_cost(c.max_cost())
+{
+    uint32_t range = static_cast<uint32_t>(_max_cost) - static_cast<uint32_t>(_min_cost);
+    while (_width < 4 && (range >> (8 * _width))) {
+        _width = (_width == 0) ? 1 : _width * 2;
+    }
+    _offsets.reserve(c.node_count() + 1);
+    _ids.reserve(c.node_count());
+    _index.reserve(c.node_count());
+    for (size_t i = 0; i < c.node_count(); ++i) {
+        _offsets.push_back(_data.size());
+        _ids.push_back(c.get_id(i));
+        _index.push_back({c.get_id(i), static_cast<index>(i)});
+        put_varint(_data, c.degree(i));
+        int64_t previous = i;
+        bool first = true;
+        for (auto a: c.arcs(i)) {
+            int64_t delta = static_cast<int64_t>(a.target) - previous;
+            if (first) {
+                put_varint(_data, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+                first = false;
+            } else {
+                put_varint(_data, static_cast<uint64_t>(delta));
+            }
+            previous = a.target;
+            uint32_t cost = static_cast<uint32_t>(a.cost) - static_cast<uint32_t>(_min_cost);
+            for (unsigned b = 0; b < _width; ++b) {
+                _data.push_back(static_cast<uint8_t>(cost >> (8 * b)));
+            }
+        }
+    }
+    _offsets.push_back(_data.size());
+    _data.shrink_to_fit();
+    sort(_index.begin(), _index.end());
+}
+
+size_t compressed_csr::degree(size_t i) const
+{
+    const uint8_t* data = _data.data() + _offsets[i];
+    return get_varint(data);
+}
+
+compressed_csr::arc_range compressed_csr::arcs(size_t i) const
+{
+    const uint8_t* data = _data.data() + _offsets[i];
+    size_t degree = get_varint(data);
+    index from = static_cast<index>(i);
+    return {arc_iterator(data, degree, from, _width, _min_cost),
+            arc_iterator(nullptr, 0, from, _width, _min_cost)};
+}
+
+size_t compressed_csr::get_index(int id) const
+{
+    auto iter = lower_bound(_index.begin(), _index.end(), make_pair(id, static_cast<index>(0)));
+    if (iter == _index.end() || iter->first != id) {
+        return csr::npos;
+    }
+    return iter->second;
+}
+
+size_t compressed_csr::memory_bytes() const
+{
+    return _data.capacity() * sizeof(uint8_t)
+           + _offsets.capacity() * sizeof(size_t)
+           + _ids.capacity() * sizeof(int)
+           + _index.capacity() * sizeof(pair<int, index>);
+}
@@ -0,0 +1,88 @@
+#ifndef __COMPRESSED_CSR__
+#define __COMPRESSED_CSR__
+
+// C++ includes
+#include "csr.hpp"
+#include "graph.hpp"
+#include <utility>      // For pair
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint8_t
+
+// Read only csr squeezed for the graphs that do not fit in memory
+// otherwise.
+//
+// The arcs of a node are sorted by target so instead of 4 byte targets
+// we store the gaps between them as varints (7 bits per byte, the high
+// bit says another byte follows), the first one relative to the node
+// itself and zigzag encoded since it may be negative. After a reorder()
+// neighbors are close and most gaps take a single byte. Costs are
+// stored as their difference to the smallest cost on 0 (all the same),
+// 1, 2 or 4 bytes, whatever the widest one needs, right after their
+// target. Every node starts with its degree as a varint and only the
+// byte offset of each node is kept, ids are looked up in a sorted
+// array instead of a hash map.
+//
+// Nothing is decoded up front: arcs(i) hands out an iterator decoding
+// one arc per step, the same loop the search engines run on a csr, so
+// bfs and dijkstra work on either (basic_bfs, basic_dijkstra). There
+// are no node references, only ids.
+class compressed_csr
+{
+    public:
+        typedef csr::index index;
+        typedef csr::arc arc;
+        class arc_iterator
+        {
+            public:
+                arc_iterator(const uint8_t* data, size_t left, index from,
+                             unsigned width, int base);
+                arc operator*() const {return _arc;}
+                arc_iterator& operator++() {if (--_left) {decode();} return *this;}
+                bool operator!=(const arc_iterator& other) const {return _left != other._left;}
+            private:
+                void decode();
+                const uint8_t* _data;
+                size_t _left;
+                unsigned _width;
+                int _base;
+                bool _first;
+                arc _arc;
+        };
+        struct arc_range
+        {
+            arc_iterator first;
+            arc_iterator last;
+            arc_iterator begin() const {return first;}
+            arc_iterator end() const {return last;}
+        };
+
+        explicit compressed_csr(graph& g);
+        explicit compressed_csr(const csr& c);
+
+        size_t node_count() const {return _ids.size();}
+        size_t arc_count() const {return _arc_count;}
+        size_t degree(size_t i) const;
+        arc_range arcs(size_t i) const;
+        size_t get_index(int id) const;
+        int get_id(size_t i) const {return _ids[i];}
+        int min_cost() const {return _min_cost;}
+        int max_cost() const {return _max_cost;}
+        bool has_uniform_cost() const {return _min_cost == _max_cost;}
+        // Heap bytes held, to compare with the other representations
+        size_t memory_bytes() const;
+    private:
+        std::vector<uint8_t> _data;
+        std::vector<size_t> _offsets;
+        std::vector<int> _ids;
+        // (id, index) sorted by id
+        std::vector<std::pair<int, index>> _index;
+        size_t _arc_count;
+        unsigned _width;
+        int _min_cost;
+        int _max_cost;
+};
+
+#endif // __COMPRESSED_CSR__
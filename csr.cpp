@@ -0,0 +1,134 @@
+#include "csr.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <utility>      // For pair
+
+using namespace std;
+
+const size_t csr::npos;
+
+csr::csr(graph& g)
+    : _nodes(),
+      _ids(),
+      _index(),
+      _offsets(),
+      _targets(),
+      _costs(),
+      _min_cost(0),
+      _max_cost(0)
+{
+    TRACE_SPAN("csr");
+    _nodes.reserve(g.node_count());
+    for (auto& n: g.get_nodes()) {
+        _index.insert({n->get_id(), static_cast<index>(_nodes.size())});
+        _nodes.push_back(n.get());
+        _ids.push_back(n->get_id());
+    }
+
+    // Count the degrees first so that every arc lands directly in place
+    _offsets.assign(_nodes.size() + 1, 0);
+    for (auto& e: g.get_edges()) {
+        auto& p = e->get_edge();
+        size_t x = get_index(p.first);
+        size_t y = get_index(p.second);
+        if (x == npos || y == npos) {
+            // Edges may reference nodes that were never added to the graph
+            continue;
+        }
+        ++_offsets[x + 1];
+        ++_offsets[y + 1];
+    }
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        _offsets[i + 1] += _offsets[i];
+    }
+    _targets.resize(_offsets.back());
+    _costs.resize(_offsets.back());
+
+    vector<size_t> fill(_offsets.begin(), _offsets.end() - 1);
+    for (auto& e: g.get_edges()) {
+        auto& p = e->get_edge();
+        size_t x = get_index(p.first);
+        size_t y = get_index(p.second);
+        if (x == npos || y == npos) {
+            continue;
+        }
+        int c = e->get_cost();
+        _targets[fill[x]] = static_cast<index>(y);
+        _costs[fill[x]++] = c;
+        _targets[fill[y]] = static_cast<index>(x);
+        _costs[fill[y]++] = c;
+    }
+    finish();
+}
+
+csr::csr(const csr& whole, const vector<size_t>& members)
+    : _nodes(),
+      _ids(),
+      _index(),
+      _offsets(),
+      _targets(),
+      _costs(),
+      _min_cost(0),
+      _max_cost(0)
+{
+    _nodes.reserve(members.size());
+    for (auto i: members) {
+        _index.insert({whole._ids[i], static_cast<index>(_nodes.size())});
+        _nodes.push_back(whole._nodes[i]);
+        _ids.push_back(whole._ids[i]);
+    }
+    _offsets.reserve(members.size() + 1);
+    _offsets.push_back(0);
+    for (auto i: members) {
+        for (size_t a = whole.arc_begin(i); a < whole.arc_end(i); ++a) {
+            auto iter = _index.find(whole._ids[whole.target(a)]);
+            if (iter == _index.end()) {
+                continue;
+            }
+            _targets.push_back(iter->second);
+            _costs.push_back(whole.cost(a));
+        }
+        _offsets.push_back(_targets.size());
+    }
+    finish();
+}
+
+void csr::finish()
+{
+    if (!_costs.empty()) {
+        auto range = minmax_element(_costs.begin(), _costs.end());
+        _min_cost = *range.first;
+        _max_cost = *range.second;
+    }
+
+    // Sorting the arcs of each node keeps the traversal order
+    // deterministic and the targets close to each other in memory
+    vector<pair<index, int>> arcs;
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        arcs.clear();
+        for (size_t a = arc_begin(i); a < arc_end(i); ++a) {
+            arcs.push_back({_targets[a], _costs[a]});
+        }
+        sort(arcs.begin(), arcs.end());
+        size_t a = arc_begin(i);
+        for (auto& arc: arcs) {
+            _targets[a] = arc.first;
+            _costs[a++] = arc.second;
+        }
+    }
+}
+
+size_t csr::get_index(graph::node& n) const
+{
+    return get_index(n.get_id());
+}
+
+size_t csr::get_index(int id) const
+{
+    auto iter = _index.find(id);
+    if (iter == _index.end()) {
+        return npos;
+    }
+    return iter->second;
+}
@@ -0,0 +1,96 @@
+#ifndef __CSR__
+#define __CSR__
+
+// C++ includes
+#include "graph.hpp"
+#include <unordered_map>
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint32_t
+
+// Compressed sparse row snapshot of a graph.
+//
+// The graph keeps its adjacency in linked lists of reference_wrapper
+// and the edge costs in a separate list of edges, which is nice to
+// mutate but terrible to traverse: every neighbor is a cache miss and
+// finding the cost of an edge is a linear scan of _edges. The search
+// engines work on this flat copy instead. Nodes get a dense index in
+// the order of graph::get_nodes() and every undirected edge is stored
+// as two arcs. The snapshot does not follow later changes to the graph
+// and the node references it hands out are only valid as long as the
+// node is not deleted, the ids remain usable after that.
+class csr
+{
+    public:
+        typedef uint32_t index;
+        static const size_t npos = static_cast<size_t>(-1);
+
+        struct arc
+        {
+            index target;
+            int cost;
+        };
+        class arc_iterator
+        {
+            public:
+                arc_iterator(const index* target, const int* cost) : _target(target), _cost(cost) {}
+                arc operator*() const {return {*_target, *_cost};}
+                arc_iterator& operator++() {++_target; ++_cost; return *this;}
+                bool operator!=(const arc_iterator& other) const {return _target != other._target;}
+            private:
+                const index* _target;
+                const int* _cost;
+        };
+        struct arc_range
+        {
+            arc_iterator first;
+            arc_iterator last;
+            arc_iterator begin() const {return first;}
+            arc_iterator end() const {return last;}
+        };
+
+        explicit csr(graph& g);
+        // Induced sub graph on the given indices of another snapshot,
+        // the members keep the order in which they are given
+        csr(const csr& whole, const std::vector<size_t>& members);
+
+        size_t node_count() const {return _nodes.size();}
+        size_t arc_count() const {return _targets.size();}
+        size_t degree(size_t i) const {return _offsets[i + 1] - _offsets[i];}
+        // Arcs of node i are [arc_begin(i), arc_end(i)) sorted by target
+        size_t arc_begin(size_t i) const {return _offsets[i];}
+        size_t arc_end(size_t i) const {return _offsets[i + 1];}
+        index target(size_t a) const {return _targets[a];}
+        int cost(size_t a) const {return _costs[a];}
+        // Same arcs for a range based for, which is all the search
+        // engines use so that they also run on a compressed_csr
+        arc_range arcs(size_t i) const
+        {
+            return {arc_iterator(_targets.data() + _offsets[i], _costs.data() + _offsets[i]),
+                    arc_iterator(_targets.data() + _offsets[i + 1], _costs.data() + _offsets[i + 1])};
+        }
+        graph::node& get_node(size_t i) const {return *_nodes[i];}
+        size_t get_index(graph::node& n) const;
+        size_t get_index(int id) const;
+        int get_id(size_t i) const {return _ids[i];}
+        int min_cost() const {return _min_cost;}
+        int max_cost() const {return _max_cost;}
+        // True when every arc has the same cost, trivially so without arcs
+        bool has_uniform_cost() const {return _min_cost == _max_cost;}
+    private:
+        void finish();
+        std::vector<graph::node*> _nodes;
+        // Copied so that ids stay readable after the nodes are gone
+        std::vector<int> _ids;
+        // Nodes compare by id everywhere else so we look them up by id too
+        std::unordered_map<int, index> _index;
+        std::vector<size_t> _offsets;
+        std::vector<index> _targets;
+        std::vector<int> _costs;
+        int _min_cost;
+        int _max_cost;
+};
+
+#endif // __CSR__
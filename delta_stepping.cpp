@@ -0,0 +1,237 @@
+#include "delta_stepping.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+using namespace std;
+
+const size_t delta_stepping::unreached;
+const uint64_t delta_stepping::none;
+
+// Below this many frontier nodes per thread the relaxation runs inline
+static const size_t node_grain = 256;
+
+// Most buckets kept in the ring, the others wait in the far heap
+static const size_t max_slots = 1 << 12;
+
+static bool far_order(const pair<size_t, csr::index>& r1, const pair<size_t, csr::index>& r2)
+{
+    return r1.first > r2.first;
+}
+
+delta_stepping::delta_stepping(const csr& c, size_t threads, int delta)
+    : _c(c),
+      _threads(threads ? threads : default_threads()),
+      _delta(delta),
+      _state(c.node_count()),
+      _buckets(),
+      _far(),
+      _current(0),
+      _queued(0),
+      _requests(),
+      _order()
+{
+    if (c.arc_count() && c.min_cost() < 0) {
+        throw runtime_error("Delta-stepping needs non negative costs");
+    }
+    for (auto& s: _state) {
+        s.store(none, memory_order_relaxed);
+    }
+    if (_delta <= 0 && c.arc_count()) {
+        vector<int> costs;
+        costs.reserve(c.arc_count());
+        for (size_t a = 0; a < c.arc_count(); ++a) {
+            costs.push_back(c.cost(a));
+        }
+        auto p90 = costs.begin() + (costs.size() * 9) / 10;
+        nth_element(costs.begin(), p90, costs.end());
+        double degree = static_cast<double>(c.arc_count()) / c.node_count();
+        _delta = static_cast<int>(*p90 / degree);
+    }
+    if (_delta <= 0) {
+        _delta = 1;
+    }
+    size_t span = c.arc_count() ? static_cast<size_t>(max(c.max_cost(), 0)) / _delta : 0;
+    _buckets.resize(min(span + 2, max_slots));
+    STATS_ADD(bytes_allocated, c.node_count() * sizeof(uint64_t));
+}
+
+uint64_t delta_stepping::pack(int distance, size_t parent)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(distance)) << 32)
+           | static_cast<uint32_t>(parent);
+}
+
+size_t delta_stepping::get_parent(size_t i) const
+{
+    uint64_t s = _state[i].load(memory_order_relaxed);
+    return s == none ? unreached : static_cast<size_t>(s & 0xffffffff);
+}
+
+int delta_stepping::get_distance(size_t i) const
+{
+    return static_cast<int>(_state[i].load(memory_order_relaxed) >> 32);
+}
+
+bool delta_stepping::improve(size_t target, int distance, size_t parent, bool tie)
+{
+    uint64_t candidate = pack(distance, parent);
+    uint64_t current = _state[target].load(memory_order_relaxed);
+    for (;;) {
+        bool shorter = (current == none) || (distance < static_cast<int>(current >> 32));
+        if (!shorter && !(tie && candidate < current)) {
+            return false;
+        }
+        if (_state[target].compare_exchange_weak(current, candidate,
+                                                 memory_order_relaxed)) {
+            return shorter;
+        }
+    }
+}
+
+void delta_stepping::relax(const vector<csr::index>& nodes, bool light)
+{
+    mutex requests_lock;
+    size_t scanned = 0;
+    _requests.clear();
+    parallel_for(0, nodes.size(), _threads, [&](size_t lo, size_t hi)
+    {
+        // Collect locally and take the lock once per chunk
+        vector<pair<size_t, csr::index>> requests;
+        size_t arcs = 0;
+        for (size_t k = lo; k < hi; ++k) {
+            size_t v = nodes[k];
+            int d = get_distance(v);
+            arcs += _c.degree(v);
+            for (size_t a = _c.arc_begin(v); a < _c.arc_end(v); ++a) {
+                int cost = _c.cost(a);
+                if ((cost <= _delta) != light) {
+                    continue;
+                }
+                // Going back over a huge arc must not wrap around to a
+                // negative distance, it cannot improve anything anyway
+                if (d > numeric_limits<int>::max() - cost) {
+                    continue;
+                }
+                csr::index t = _c.target(a);
+                if (improve(t, d + cost, v, cost > 0)) {
+                    requests.push_back({static_cast<size_t>((d + cost) / _delta), t});
+                }
+            }
+        }
+        lock_guard<mutex> lock(requests_lock);
+        _requests.insert(_requests.end(), requests.begin(), requests.end());
+        scanned += arcs;
+    }, node_grain);
+    STATS_ADD(edges_relaxed, scanned);
+    for (auto& r: _requests) {
+        queue(r.first, r.second);
+    }
+}
+
+void delta_stepping::queue(size_t b, csr::index v)
+{
+    if (b - _current < _buckets.size()) {
+        _buckets[b % _buckets.size()].push_back(v);
+        ++_queued;
+    } else {
+        _far.push_back({b, v});
+        push_heap(_far.begin(), _far.end(), far_order);
+    }
+}
+
+void delta_stepping::run(size_t source)
+{
+    for (auto i: _order) {
+        _state[i].store(none, memory_order_relaxed);
+    }
+    _order.clear();
+    for (auto& b: _buckets) {
+        b.clear();
+    }
+    _far.clear();
+    _current = 0;
+    _queued = 0;
+    if (source >= _c.node_count()) {
+        return;
+    }
+    _state[source].store(pack(0, source), memory_order_relaxed);
+    queue(0, static_cast<csr::index>(source));
+    STATS_MAX(peak_threads, _threads);
+
+    vector<csr::index> frontier;
+    vector<csr::index> settled;
+    for (;; ++_current) {
+        if (!_queued) {
+            if (_far.empty()) {
+                break;
+            }
+            // Nothing close, skip the empty buckets in between
+            _current = _far.front().first;
+        }
+        while (!_far.empty() && _far.front().first - _current < _buckets.size()) {
+            pop_heap(_far.begin(), _far.end(), far_order);
+            queue(_far.back().first, _far.back().second);
+            _far.pop_back();
+        }
+        size_t i = _current;
+        auto& bucket = _buckets[i % _buckets.size()];
+        settled.clear();
+        while (!bucket.empty()) {
+            frontier.clear();
+            frontier.swap(bucket);
+            _queued -= frontier.size();
+            sort(frontier.begin(), frontier.end());
+            frontier.erase(unique(frontier.begin(), frontier.end()), frontier.end());
+            // Nodes improved into a lower bucket since they were queued
+            // are stale here, they have already been handled
+            frontier.erase(remove_if(frontier.begin(), frontier.end(),
+                                     [&](csr::index v)
+                                     {
+                                         return static_cast<size_t>(get_distance(v) / _delta) != i;
+                                     }),
+                           frontier.end());
+            settled.insert(settled.end(), frontier.begin(), frontier.end());
+            relax(frontier, true);
+        }
+        sort(settled.begin(), settled.end());
+        settled.erase(unique(settled.begin(), settled.end()), settled.end());
+        STATS_ADD(nodes_settled, settled.size());
+        relax(settled, false);
+    }
+    build_order(source);
+}
+
+void delta_stepping::build_order(size_t source)
+{
+    // Zero cost arcs give children the distance of their parent so
+    // sorting by distance is not enough, walk the tree instead
+    size_t n = _c.node_count();
+    vector<size_t> first(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        size_t p = get_parent(i);
+        if (p != unreached && i != source) {
+            ++first[p + 1];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        first[i + 1] += first[i];
+    }
+    vector<size_t> children(first[n]);
+    vector<size_t> fill(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        size_t p = get_parent(i);
+        if (p != unreached && i != source) {
+            children[fill[p]++] = i;
+        }
+    }
+    _order.push_back(source);
+    for (size_t head = 0; head < _order.size(); ++head) {
+        size_t v = _order[head];
+        _order.insert(_order.end(), children.begin() + first[v], children.begin() + first[v + 1]);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef __DELTA_STEPPING__
+#define __DELTA_STEPPING__
+
+// C++ includes
+#include "csr.hpp"
+#include <atomic>
+#include <utility>      // For pair
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint64_t
+
+// Parallel single source shortest paths by delta-stepping (Meyer and
+// Sanders).
+//
+// Tentative distances are kept in buckets of width delta. The smallest
+// non empty bucket is emptied by relaxing the light arcs (cost <= delta)
+// of its nodes in parallel, which may refill it, until it stays empty;
+// its nodes are then final and their heavy arcs are relaxed once, again
+// in parallel. Distance and parent of a node are packed in one 64 bit
+// word (distance in the high half) updated with a compare and swap
+// minimum, so concurrent relaxations never lose an update and the
+// distances are exactly Dijkstra's. Equal distances keep the smallest
+// parent index so without zero cost arcs the tree does not depend on
+// the scheduling either.
+//
+// A delta of 0 picks one from the costs: the 90th percentile arc cost
+// divided by the average degree, after Meyer and Sanders' max cost over
+// degree without letting a few outliers blow up the buckets. Negative
+// costs are not supported and throw runtime_error.
+//
+// While bucket i is emptied every tentative distance is below
+// (i + 1) * delta + max cost, so the buckets live in a ring of that
+// many slots past the current one. The ring is capped, buckets further
+// away wait in a heap and move to the ring as it gets close to them,
+// and when the ring runs empty the search jumps straight to the first
+// of them. A few very expensive arcs therefore cost neither memory nor
+// a walk over millions of empty buckets.
+class delta_stepping
+{
+    public:
+        static const size_t unreached = static_cast<size_t>(-1);
+
+        explicit delta_stepping(const csr& c, size_t threads = 0, int delta = 0);
+        delta_stepping(const delta_stepping&) = delete;
+        delta_stepping& operator=(const delta_stepping&) = delete;
+
+        void run(size_t source);
+        size_t get_parent(size_t i) const;
+        int get_distance(size_t i) const;
+        int get_delta() const {return _delta;}
+        // Reached nodes, every parent before its children
+        const std::vector<size_t>& get_order() const {return _order;}
+    private:
+        static const uint64_t none = static_cast<uint64_t>(-1);
+        static uint64_t pack(int distance, size_t parent);
+        // True when the distance went down. Ties only move the parent
+        // to a smaller index through positive arcs: through zero cost
+        // arcs two nodes at the same distance could adopt each other.
+        bool improve(size_t target, int distance, size_t parent, bool tie);
+        void relax(const std::vector<csr::index>& nodes, bool light);
+        // Queue a node for bucket b, never below the current bucket
+        void queue(size_t b, csr::index v);
+        void build_order(size_t source);
+
+        const csr& _c;
+        size_t _threads;
+        int _delta;
+        std::vector<std::atomic<uint64_t>> _state;
+        // Bucket b is _buckets[b % _buckets.size()] while it is less
+        // than _buckets.size() past _current, in _far otherwise
+        std::vector<std::vector<csr::index>> _buckets;
+        std::vector<std::pair<size_t, csr::index>> _far; // Min heap
+        size_t _current;
+        size_t _queued; // Entries in the ring
+        std::vector<std::pair<size_t, csr::index>> _requests;
+        std::vector<size_t> _order;
+};
+
+#endif // __DELTA_STEPPING__
@@ -0,0 +1,92 @@
+#include "dijkstra.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+template <typename Adjacency>
+const size_t basic_dijkstra<Adjacency>::unreached;
+
+template <typename Adjacency>
+basic_dijkstra<Adjacency>::basic_dijkstra(const Adjacency& c)
+    : _c(c),
+      _parent(c.node_count(), unreached),
+      _distance(c.node_count(), 0),
+      _closed(c.node_count(), false),
+      _open(),
+      _order()
+{
+    STATS_ADD(bytes_allocated, c.node_count() * (sizeof(size_t) + sizeof(int))
+                               + c.node_count() / 8);
+}
+
+template <typename Adjacency>
+void basic_dijkstra<Adjacency>::run(size_t source, size_t target)
+{
+    // Every node the previous run reached was either settled or is
+    // still waiting in the open set after an early stop, only those
+    // need a reset
+    for (auto i: _order) {
+        _closed[i] = false;
+        _parent[i] = unreached;
+    }
+    for (auto& e: _open) {
+        _parent[e.second] = unreached;
+    }
+    _open.clear();
+    _order.clear();
+    if (source >= _c.node_count()) {
+        return;
+    }
+#ifdef SHORTEST_PATH_STATS
+    size_t capacity = _open.capacity();
+#endif
+    _parent[source] = source;
+    _distance[source] = 0;
+    _open.push_back({0, source});
+    STATS_ADD(heap_pushes, 1);
+    while (!_open.empty()) {
+        STATS_MAX(peak_open_set, _open.size());
+        pop_heap(_open.begin(), _open.end(), open_set_order());
+        entry current = _open.back();
+        _open.pop_back();
+        STATS_ADD(heap_pops, 1);
+        size_t v = current.second;
+        if (_closed[v] || current.first != _distance[v]) {
+            continue; // Stale entry, a shorter path was found since
+        }
+        _closed[v] = true;
+        _order.push_back(v);
+        STATS_ADD(nodes_settled, 1);
+        if (v == target) {
+            break;
+        }
+        for (auto a: _c.arcs(v)) {
+            size_t t = a.target;
+            STATS_ADD(edges_relaxed, 1);
+            if (_closed[t]) {
+                continue;
+            }
+            int d = current.first + a.cost;
+            if (_parent[t] == unreached || d < _distance[t]) {
+                // A lower priority for a node already in the open
+                // set is our decrease-key
+                if (_parent[t] != unreached) {
+                    STATS_ADD(decrease_keys, 1);
+                }
+                _parent[t] = v;
+                _distance[t] = d;
+                _open.push_back({d, t});
+                push_heap(_open.begin(), _open.end(), open_set_order());
+                STATS_ADD(heap_pushes, 1);
+            }
+        }
+    }
+#ifdef SHORTEST_PATH_STATS
+    STATS_ADD(bytes_allocated, (_open.capacity() - capacity) * sizeof(entry));
+#endif
+}
+
+template class basic_dijkstra<csr>;
+template class basic_dijkstra<compressed_csr>;
@@ -0,0 +1,70 @@
+#ifndef __DIJKSTRA__
+#define __DIJKSTRA__
+
+// C++ includes
+#include "compressed_csr.hpp"
+#include "csr.hpp"
+#include <utility>      // For pair
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Single source Dijkstra over a csr snapshot, or a compressed_csr for
+// basic_dijkstra<compressed_csr>.
+//
+// WARNING: Never use std::priority_queue
+// it is pure garbage. There is no way to
+// know if an element is in the queue. There
+// is no way to change the priority of an
+// element. Having access to the underlying
+// container could help work around the issue
+// but there is again no access to the underlying
+// container. So you are better off implementing
+// your own priority queue (heap) or use
+// vector and make_heap
+//
+// Here the open set is a vector kept as a heap with push_heap/pop_heap.
+// Instead of looking for a node in the heap to lower its priority we
+// push it again and skip the stale entries when they surface, which
+// keeps every operation logarithmic. Like bfs the engine keeps its
+// buffers between runs.
+template <typename Adjacency>
+class basic_dijkstra
+{
+    public:
+        static const size_t unreached = static_cast<size_t>(-1);
+
+        explicit basic_dijkstra(const Adjacency& c);
+        basic_dijkstra(const basic_dijkstra&) = delete;
+        basic_dijkstra& operator=(const basic_dijkstra&) = delete;
+
+        // Stops as soon as target is settled when one is given
+        void run(size_t source, size_t target = unreached);
+        size_t get_parent(size_t i) const {return _parent[i];}
+        int get_distance(size_t i) const {return _distance[i];}
+        // Settled nodes in increasing distance, the source first
+        const std::vector<size_t>& get_order() const {return _order;}
+    private:
+        typedef std::pair<int, size_t> entry;
+        struct open_set_order
+        {
+            bool operator()(const entry& e1, const entry& e2) const
+            {
+                return e1.first > e2.first;
+            }
+        };
+        const Adjacency& _c;
+        std::vector<size_t> _parent;
+        std::vector<int> _distance;
+        std::vector<bool> _closed;
+        std::vector<entry> _open;
+        std::vector<size_t> _order;
+};
+
+// Both are compiled once in dijkstra.cpp
+extern template class basic_dijkstra<csr>;
+extern template class basic_dijkstra<compressed_csr>;
+typedef basic_dijkstra<csr> dijkstra;
+
+#endif // __DIJKSTRA__
@@ -0,0 +1,57 @@
+#include "executor.hpp"
+#include "parallel.hpp"
+
+using namespace std;
+
+executor::executor(size_t threads)
+    : _lock(),
+      _wake(),
+      _tasks(),
+      _stopping(false),
+      _threads()
+{
+    if (!threads) {
+        threads = default_threads();
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        _threads.push_back(thread(&executor::work, this));
+    }
+}
+
+executor::~executor()
+{
+    {
+        lock_guard<mutex> lock(_lock);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto& t: _threads) {
+        t.join();
+    }
+}
+
+void executor::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(_lock);
+        _tasks.push_back(move(task));
+    }
+    _wake.notify_one();
+}
+
+void executor::work()
+{
+    for (;;) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(_lock);
+            _wake.wait(lock, [this]() {return _stopping || !_tasks.empty();});
+            if (_tasks.empty()) {
+                return; // Stopping and nothing left to do
+            }
+            task = move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
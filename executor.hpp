@@ -0,0 +1,38 @@
+#ifndef __EXECUTOR__
+#define __EXECUTOR__
+
+// C++ includes
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Fixed pool of worker threads running submitted tasks in FIFO order.
+// At most thread_count() tasks run at the same time, the others wait
+// in the queue. The destructor runs whatever is still queued before
+// joining the workers.
+class executor
+{
+    public:
+        // 0 threads picks one per hardware thread
+        explicit executor(size_t threads = 0);
+        ~executor();
+        executor(const executor&) = delete;
+        executor& operator=(const executor&) = delete;
+        void submit(std::function<void()> task);
+        size_t thread_count() const {return _threads.size();}
+    private:
+        void work();
+        std::mutex _lock;
+        std::condition_variable _wake;
+        std::deque<std::function<void()>> _tasks;
+        bool _stopping;
+        std::vector<std::thread> _threads;
+};
+
+#endif // __EXECUTOR__
@@ -1,20 +1,25 @@
 #include "graph.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <typeinfo>
+#include <unordered_map>
 
 using namespace std;
 
-size_t graph::node_count()
+template <typename Cost, typename Id>
+size_t basic_graph<Cost, Id>::node_count()
 {
     return _node_count;
 }
 
-size_t graph::edge_count()
+template <typename Cost, typename Id>
+size_t basic_graph<Cost, Id>::edge_count()
 {
     return _edge_count;
 }
 
-bool graph::adjacent(node& x, node& y)
+template <typename Cost, typename Id>
+bool basic_graph<Cost, Id>::adjacent(node& x, node& y)
 {
     auto iter = get_node_iterator(x);
     if (iter == _nodes.end()) {
@@ -23,36 +28,57 @@ bool graph::adjacent(node& x, node& y)
     return (*iter)->has_neighbor(y);
 }
 
-graph::node& graph::add_node(int id)
+template <typename Cost, typename Id>
+typename basic_graph<Cost, Id>::node& basic_graph<Cost, Id>::add_node(Id id)
 {
     auto p = node_ptr(new node(id));
     auto& n = *p;
     _nodes.push_back(move(p));
     ++_node_count;
+    ++_component_count;
     return n;
 }
 
-graph::node& graph::add_node()
+template <typename Cost, typename Id>
+typename basic_graph<Cost, Id>::node& basic_graph<Cost, Id>::add_node()
 {
-    int id = get_id();
+    Id id = get_id();
     return add_node(id);
 }
-void graph::delete_node(node& x)
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::delete_node(node& x)
 {
     auto iter = get_node_iterator(x);
     if (iter == _nodes.end()) {
         return;
     }
-    _nodes.remove(*iter);
+    // Drop the edges first so that nothing keeps a reference
+    // to the node once its memory is released
+    node& n = **iter;
+    for (auto e = _edges.begin(); e != _edges.end();) {
+        auto& p = (*e)->get_edge();
+        if (p.first.get() == n || p.second.get() == n) {
+            p.first.get().remove_neighbor(p.second);
+            p.second.get().remove_neighbor(p.first);
+            e = _edges.erase(e);
+            --_edge_count;
+        } else {
+            ++e;
+        }
+    }
+    _nodes.erase(iter);
     --_node_count;
+    _components_stale = true;
 }
 
-bool graph::has_node(node& x)
+template <typename Cost, typename Id>
+bool basic_graph<Cost, Id>::has_node(node& x)
 {
     return get_node_iterator(x) != _nodes.end();
 }
 
-list<graph::node_ptr>::iterator graph::get_node_iterator(node& x)
+template <typename Cost, typename Id>
+typename list<typename basic_graph<Cost, Id>::node_ptr>::iterator basic_graph<Cost, Id>::get_node_iterator(node& x)
 {
     return find_if (_nodes.begin(),
                         _nodes.end(),
@@ -60,20 +86,31 @@ list<graph::node_ptr>::iterator graph::get_node_iterator(node& x)
                         );
 }
 
-graph::edge& graph::add_edge(node& x, node& y, int cost)
+template <typename Cost, typename Id>
+typename basic_graph<Cost, Id>::edge& basic_graph<Cost, Id>::add_edge(node& x, node& y, Cost cost)
 {
     auto ix = get_node_iterator(x);
     auto iy = get_node_iterator(y);
-    (*ix)->add_neighbor(**iy);
-    (*iy)->add_neighbor(**ix);
-    auto p = edge_ptr(new edge(**ix, **iy, cost));
+    return link(**ix, **iy, cost);
+}
+
+template <typename Cost, typename Id>
+typename basic_graph<Cost, Id>::edge& basic_graph<Cost, Id>::link(node& x, node& y, Cost cost)
+{
+    x.add_neighbor(y);
+    y.add_neighbor(x);
+    auto p = edge_ptr(new edge(x, y, cost));
     auto& e = *p;
     _edges.push_back(move(p));
     ++_edge_count;
+    if (!_components_stale) {
+        unite(x, y);
+    }
     return e;
 }
 
-void graph::delete_edge(node& x, node& y)
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::delete_edge(node& x, node& y)
 {
     for (auto& e: _edges) {
         if (e->is_edge(x, y)) {
@@ -81,17 +118,20 @@ void graph::delete_edge(node& x, node& y)
             x.remove_neighbor(y);
             y.remove_neighbor(x);
             --_edge_count;
+            _components_stale = true;
             return;
         }
     }
 }
 
-bool graph::has_edge(node& x, node& y)
+template <typename Cost, typename Id>
+bool basic_graph<Cost, Id>::has_edge(node& x, node& y)
 {
     return get_edge_iterator(x, y) != _edges.end();
 }
 
-list<graph::edge_ptr>::iterator graph::get_edge_iterator(node& x, node& y)
+template <typename Cost, typename Id>
+typename list<typename basic_graph<Cost, Id>::edge_ptr>::iterator basic_graph<Cost, Id>::get_edge_iterator(node& x, node& y)
 {
     auto iter = find_if(_edges.begin(),
                         _edges.end(),
@@ -103,29 +143,174 @@ list<graph::edge_ptr>::iterator graph::get_edge_iterator(node& x, node& y)
     return iter;
 }
 
-int graph::get_node_value(node& x)
+template <typename Cost, typename Id>
+Id basic_graph<Cost, Id>::get_node_value(node& x)
 {
     return x.get_id();
 }
 
-void graph::set_node_value(node& x, int id)
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::set_node_value(node& x, Id id)
 {
     x.set_id(id);
 }
 
-int graph::get_edge_value(edge& e)
+template <typename Cost, typename Id>
+Cost basic_graph<Cost, Id>::get_edge_value(edge& e)
 {
     return e.get_cost();
 }
 
-void graph::set_edge_value(edge& e, int cost)
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::set_edge_value(edge& e, Cost cost)
 {
     e.set_cost(cost);
 }
 
-graph::graph_ptr graph::generate_graph(size_t size, double density, int min_cost, int max_cost)
+template <typename Cost, typename Id>
+typename basic_graph<Cost, Id>::node& basic_graph<Cost, Id>::find_component(node& x)
+{
+    if (_components_stale) {
+        rebuild_components();
+    }
+    // Path halving: every visited node skips to its grand parent
+    node* current = &x;
+    while (current->_leader) {
+        if (current->_leader->_leader) {
+            current->_leader = current->_leader->_leader;
+        }
+        current = current->_leader;
+    }
+    return *current;
+}
+
+template <typename Cost, typename Id>
+bool basic_graph<Cost, Id>::connected(node& x, node& y)
+{
+    return &find_component(x) == &find_component(y);
+}
+
+template <typename Cost, typename Id>
+size_t basic_graph<Cost, Id>::component_count()
+{
+    if (_components_stale) {
+        rebuild_components();
+    }
+    return _component_count;
+}
+
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::unite(node& x, node& y)
+{
+    node* rx = &find_component(x);
+    node* ry = &find_component(y);
+    if (rx == ry) {
+        return;
+    }
+    // Union by rank keeps the trees logarithmic
+    if (rx->_rank < ry->_rank) {
+        swap(rx, ry);
+    }
+    ry->_leader = rx;
+    if (rx->_rank == ry->_rank) {
+        ++rx->_rank;
+    }
+    --_component_count;
+}
+
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::rebuild_components()
 {
-    auto g = graph_ptr(new graph);
+    _components_stale = false;
+    _component_count = _node_count;
+    for (auto& n: _nodes) {
+        n->_leader = nullptr;
+        n->_rank = 0;
+    }
+    for (auto& e: _edges) {
+        auto& p = e->get_edge();
+        unite(p.first, p.second);
+    }
+}
+
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::reorder(ordering strategy)
+{
+    // Work on positions, the list is only touched at the very end
+    vector<typename list<node_ptr>::iterator> position;
+    unordered_map<node*, size_t> index;
+    for (auto iter = _nodes.begin(); iter != _nodes.end(); ++iter) {
+        index.insert({iter->get(), position.size()});
+        position.push_back(iter);
+    }
+    size_t n = position.size();
+    auto degree = [&](size_t i) {return (*position[i])->_neighbors.size();};
+
+    vector<size_t> order;
+    order.reserve(n);
+    if (strategy == ordering::degree) {
+        for (size_t i = 0; i < n; ++i) {
+            order.push_back(i);
+        }
+        stable_sort(order.begin(), order.end(),
+                    [&](size_t i, size_t j) {return degree(i) > degree(j);});
+    } else {
+        bool cuthill_mckee = (strategy == ordering::reverse_cuthill_mckee);
+        vector<bool> visited(n, false);
+        vector<size_t> roots;
+        for (size_t i = 0; i < n; ++i) {
+            roots.push_back(i);
+        }
+        if (cuthill_mckee) {
+            // Low degree nodes sit at the periphery of their component
+            // which is where Cuthill-McKee wants to start
+            stable_sort(roots.begin(), roots.end(),
+                        [&](size_t i, size_t j) {return degree(i) < degree(j);});
+        }
+        vector<size_t> neighbors;
+        for (auto root: roots) {
+            if (visited[root]) {
+                continue;
+            }
+            visited[root] = true;
+            size_t head = order.size();
+            order.push_back(root);
+            while (head < order.size()) {
+                size_t current = order[head++];
+                neighbors.clear();
+                for (auto& neighbor: (*position[current])->_neighbors) {
+                    auto iter = index.find(&neighbor.get());
+                    if (iter != index.end() && !visited[iter->second]) {
+                        visited[iter->second] = true;
+                        neighbors.push_back(iter->second);
+                    }
+                }
+                if (cuthill_mckee) {
+                    stable_sort(neighbors.begin(), neighbors.end(),
+                                [&](size_t i, size_t j) {return degree(i) < degree(j);});
+                }
+                order.insert(order.end(), neighbors.begin(), neighbors.end());
+            }
+        }
+        if (cuthill_mckee) {
+            reverse(order.begin(), order.end());
+        }
+    }
+
+    // Moving every node to the back in the new order leaves the
+    // list sorted without reallocating anything
+    for (auto i: order) {
+        _nodes.splice(_nodes.end(), _nodes, position[i]);
+    }
+    _permutation = move(order);
+}
+
+template <typename Cost, typename Id>
+typename basic_graph<Cost, Id>::graph_ptr basic_graph<Cost, Id>::generate_graph(size_t size, double density, Cost min_cost, Cost max_cost, unsigned seed)
+{
+    TRACE_SPAN("generate_graph");
+    srand(seed);
+    auto g = graph_ptr(new basic_graph);
     auto p = density_generator(density);
     auto c = cost_generator(min_cost, max_cost);
     
@@ -145,7 +330,8 @@ graph::graph_ptr graph::generate_graph(size_t size, double density, int min_cost
     return g;
 }
 
-bool graph::edge::is_edge(node& x, node& y)
+template <typename Cost, typename Id>
+bool basic_graph<Cost, Id>::edge::is_edge(node& x, node& y)
 {
     node& first = _edge.first;
     node& second = _edge.second;
@@ -153,23 +339,27 @@ bool graph::edge::is_edge(node& x, node& y)
            || (first == y && second == x) );
 }
 
-void graph::node::add_neighbor(node& x)
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::node::add_neighbor(node& x)
 {
     _neighbors.push_back(x);
 }
 
-void graph::node::remove_neighbor(node& x)
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::node::remove_neighbor(node& x)
 {
     _neighbors.remove_if(compare_node_wrapper(x));
 }
 
-bool graph::node::has_neighbor(node& x)
+template <typename Cost, typename Id>
+bool basic_graph<Cost, Id>::node::has_neighbor(node& x)
 {
     auto iter = find_if(_neighbors.begin(), _neighbors.end(), compare_node_wrapper(x));
     return iter != _neighbors.end();
 }
 
-void graph::node::print_neighbors()
+template <typename Cost, typename Id>
+void basic_graph<Cost, Id>::node::print_neighbors()
 {
     for (auto n: _neighbors) {
         cout << n << ", ";
@@ -177,18 +367,8 @@ void graph::node::print_neighbors()
     cout << endl;
 }
 
-ostream& operator<<(ostream& out, graph::node& n)
-{
-    return out << "N(" << n.get_id() << ")";
-}
-
-ostream& operator<<(ostream& out, graph::edge& e)
-{
-    auto& p = e.get_edge();
-    return out << p.first.get() << " <-" << e.get_cost() <<"-> " << p.second.get();
-}
-
-ostream& operator<<(ostream& out, graph& g)
+template <typename Cost, typename Id>
+ostream& operator<<(ostream& out, basic_graph<Cost, Id>& g)
 {
     out << endl;
     out << "Nodes: " << endl;
@@ -203,3 +383,13 @@ ostream& operator<<(ostream& out, graph& g)
     return out;
 }
 
+template class basic_graph<int, int>;
+template class basic_graph<int, uint32_t>;
+template class basic_graph<float, int>;
+template class basic_graph<double, int>;
+template class basic_graph<double, uint32_t>;
+template ostream& operator<<(ostream& out, basic_graph<int, int>& g);
+template ostream& operator<<(ostream& out, basic_graph<int, uint32_t>& g);
+template ostream& operator<<(ostream& out, basic_graph<float, int>& g);
+template ostream& operator<<(ostream& out, basic_graph<double, int>& g);
+template ostream& operator<<(ostream& out, basic_graph<double, uint32_t>& g);
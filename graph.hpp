@@ -6,11 +6,13 @@
 #include <iostream>
 #include <list>
 #include <memory>       // For unique_ptr
+#include <type_traits>  // For is_integral
 #include <utility>      // For pair
 #include <vector>
 
 // C includes
 #include <cstddef>      // For size_t
+#include <cstdint>      // For uint32_t
 #include <cstdlib>      // For rand
 #include <ctime>
 
@@ -20,74 +22,129 @@
 
 //TODO: move from list to unordered_map
 
-class graph
+class graph_builder;
+
+// The graph is generic on the type of its costs and of its node ids.
+// graph (int costs and ids) is the one everything else in here works
+// with, the others only come with basic_shortest_path. The members are
+// compiled in graph.cpp for the combinations declared at the end of
+// this file, add a line there and there for a new one.
+template <typename Cost, typename Id>
+class basic_graph
 {
     public:
+        typedef Cost cost_type;
+        typedef Id id_type;
+        friend class graph_builder;
         class node; // forrward declaration for edge
         typedef std::reference_wrapper<node> node_ref;
 
         class edge
         {
             public:
-                friend class graph;
-                edge(node& x, node& y, int cost = 0) : _cost(cost), _edge(x, y) {}
+                friend class basic_graph;
+                edge(node& x, node& y, Cost cost = Cost()) : _cost(cost), _edge(x, y) {}
                 bool is_edge(node& x, node& y);
                 const std::pair<node_ref, node_ref>& get_edge() {return _edge;}
-                int get_cost() {return _cost;}
-                void set_cost(int cost) {_cost = cost;}
+                Cost get_cost() {return _cost;}
+                void set_cost(Cost cost) {_cost = cost;}
+                friend std::ostream& operator<<(std::ostream& out, edge& e)
+                {
+                    return out << e._edge.first.get() << " <-" << e._cost << "-> " << e._edge.second.get();
+                }
             private:
-                int _cost;
+                Cost _cost;
                 std::pair<node_ref, node_ref> _edge;
         };
 
         class node
         {
             public:
-                friend class graph;
-                node(int id = 0) : _id(id){};
+                friend class basic_graph;
+                node(Id id = Id()) : _id(id), _leader(nullptr), _rank(0){};
                 void add_neighbor(node& x);
                 void remove_neighbor(node& x);
-                void set_id(int id) {_id = id;}
-                int get_id() {return _id;}
+                void set_id(Id id) {_id = id;}
+                Id get_id() {return _id;}
                 bool has_neighbor(node& x);
                 bool has_neighbors(){return !_neighbors.empty();}
                 void print_neighbors();
                 bool operator==(node& other) {return (_id == other._id);}
                 bool operator!=(node& other) {return !this->operator==(other);}
                 const std::list<node_ref>& get_neighbors(){return _neighbors;}
+                friend std::ostream& operator<<(std::ostream& out, node& n)
+                {
+                    return out << "N(" << n._id << ")";
+                }
             private:
                 std::list<node_ref> _neighbors;
-                int _id;
+                Id _id;
+                // Union-find links for the connected components
+                // index, nullptr when the node leads its component
+                node* _leader;
+                unsigned _rank;
         };
 
+        typedef std::reference_wrapper<edge> edge_ref;
         typedef std::unique_ptr<edge> edge_ptr;
         typedef std::unique_ptr<node> node_ptr;
-        typedef std::unique_ptr<graph> graph_ptr;
+        typedef std::unique_ptr<basic_graph> graph_ptr;
 
         size_t node_count();
         size_t edge_count();
         bool adjacent(node& x, node& y);
-        node& add_node(int id);
+        node& add_node(Id id);
         node& add_node();
         void delete_node(node& x);
         bool has_node(node& x);
-        std::list<node_ptr>::iterator get_node_iterator(node& x);
-        edge& add_edge(node& x, node& y, int cost = 0);
+        typename std::list<node_ptr>::iterator get_node_iterator(node& x);
+        edge& add_edge(node& x, node& y, Cost cost = Cost());
         void delete_edge(node& x, node& y);
         bool has_edge(node& x, node& y);
-        std::list<edge_ptr>::iterator get_edge_iterator(node& x, node& y);
-        int get_node_value(node& x);
-        void set_node_value(node& x, int id);
-        int get_edge_value(edge& e);
-        void set_edge_value(edge& e, int cost);
+        typename std::list<edge_ptr>::iterator get_edge_iterator(node& x, node& y);
+        Id get_node_value(node& x);
+        void set_node_value(node& x, Id id);
+        Cost get_edge_value(edge& e);
+        void set_edge_value(edge& e, Cost cost);
+        // Random graph, costs are drawn in [min_cost, max_cost). The
+        // seed defaults to the current time, pass one explicitly to
+        // get the same graph back.
         static graph_ptr generate_graph(size_t size,
                                         double density = 0.1,
-                                        int min_cost = 0.0,
-                                        int max_cost = 10.0);
+                                        Cost min_cost = 0,
+                                        Cost max_cost = 10,
+                                        unsigned seed = time(0));
+        // Connected components index. It is a union-find over the
+        // nodes updated by add_node/add_edge in O(alpha(n)). Deleting
+        // edges or nodes cannot be undone in a union-find so it only
+        // marks the index stale and the next query rebuilds it.
+        node& find_component(node& x);
+        bool connected(node& x, node& y);
+        size_t component_count();
         const std::list<node_ptr>& get_nodes() {return _nodes;}
         const std::list<edge_ptr>& get_edges() {return _edges;}
 
-        int get_id() {return _id++;}
+        // Node order used by the snapshots (csr) and therefore by the
+        // shortest path tables. It starts as insertion order which
+        // scatters neighbors all over the arrays, reorder() moves
+        // them so that neighbors get close positions:
+        //  - reverse_cuthill_mckee: breadth first from a low degree
+        //    node, neighbors by increasing degree, then reversed.
+        //    Minimizes the bandwidth of the adjacency matrix
+        //  - degree: hubs first, they are the nodes touched the most
+        //  - breadth_first: plain breadth first order
+        // Ids are left alone, get_permutation() maps every new position
+        // to the position the node had before the last reorder.
+        enum class ordering
+        {
+            reverse_cuthill_mckee,
+            degree,
+            breadth_first
+        };
+        void reorder(ordering strategy);
+        const std::vector<size_t>& get_permutation() {return _permutation;}
+
+        Id get_id() {return _id++;}
 
         // The graph own the memory associated with the node
         // and edges so we want to strore references in node
@@ -123,21 +180,31 @@ class graph
             private:
                 node& _x;
         };
-        graph(): _node_count(0),
+        basic_graph(): _node_count(0),
                  _edge_count(0),
                  _nodes(),
                  _edges(),
-                 _id(0) {}
+                 _id(0),
+                 _component_count(0),
+                 _components_stale(false),
+                 _permutation() {}
     private:
         size_t _node_count;
         size_t _edge_count;
         std::list<node_ptr> _nodes;
         std::list<edge_ptr> _edges;
-        int _id;
+        Id _id;
+        size_t _component_count;
+        bool _components_stale;
+        std::vector<size_t> _permutation;
+        // add_edge without looking the nodes up, they must be ours
+        edge& link(node& x, node& y, Cost cost);
+        void unite(node& x, node& y);
+        void rebuild_components();
         class density_generator
         {
             public:
-                density_generator(double density = 0.1) : _density(density){srand(time(0));}
+                density_generator(double density = 0.1) : _density(density){}
                 bool operator()() {return ((static_cast<double>(rand())/RAND_MAX) < _density);}
             private:
                 double _density;
@@ -145,21 +212,37 @@ class graph
         class cost_generator
         {
             public:
-                cost_generator(int min_cost = 0.0, int max_cost = 10.0)
+                cost_generator(Cost min_cost = 0, Cost max_cost = 10)
                     : _min_cost(min_cost),
                       _max_cost(max_cost),
-                      _range(max_cost - min_cost){srand(time(0));}
-                int operator()() {return (_min_cost + (rand() % _range));}
+                      _range(max_cost - min_cost){}
+                Cost operator()() {return draw(std::is_integral<Cost>());}
             private:
-                int _min_cost;
-                int _max_cost;
-                int _range;
+                // Both are compiled for every Cost, only one is called
+                Cost draw(std::true_type)
+                {
+                    long range = static_cast<long>(_range);
+                    return _min_cost + static_cast<Cost>(range > 0 ? rand() % range : 0);
+                }
+                Cost draw(std::false_type)
+                {
+                    return _min_cost + static_cast<Cost>(_range * (rand() / (RAND_MAX + 1.0)));
+                }
+                Cost _min_cost;
+                Cost _max_cost;
+                Cost _range;
         };
 };
 
-// Display facilities
-std::ostream& operator<<(std::ostream& out, graph::node& n);
-std::ostream& operator<<(std::ostream& out, graph::edge& e);
-std::ostream& operator<<(std::ostream& out, graph& g);
+// Display facilities, nodes and edges have theirs as friends
+template <typename Cost, typename Id>
+std::ostream& operator<<(std::ostream& out, basic_graph<Cost, Id>& g);
+
+extern template class basic_graph<int, int>;
+extern template class basic_graph<int, uint32_t>;
+extern template class basic_graph<float, int>;
+extern template class basic_graph<double, int>;
+extern template class basic_graph<double, uint32_t>;
+typedef basic_graph<int, int> graph;
 
 #endif // __GRAPH__
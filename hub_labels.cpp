@@ -0,0 +1,199 @@
+#include "hub_labels.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+const int hub_labels::unreachable = numeric_limits<int>::max();
+
+hub_labels::hub_labels(graph& g)
+    : _c(g),
+      _order(_c.node_count()),
+      _offsets(),
+      _hubs(),
+      _distances(),
+      _parents()
+{
+    if (_c.min_cost() < 0) {
+        throw runtime_error("Hub labels need non negative costs");
+    }
+    for (size_t i = 0; i < _order.size(); ++i) {
+        _order[i] = i;
+    }
+    stable_sort(_order.begin(), _order.end(), [&](csr::index i, csr::index j)
+    {
+        return _c.degree(i) > _c.degree(j);
+    });
+    // Hubs are added in rank order so every label comes out sorted
+    vector<vector<label>> labels(_c.node_count());
+    // Buffers shared by all the searches, each one cleans up after
+    // itself so that a small pruned search stays cheap
+    vector<int> hub_distance(_c.node_count(), unreachable);
+    vector<int> distance(_c.node_count(), unreachable);
+    vector<csr::index> parent(_c.node_count());
+    for (size_t r = 0; r < _order.size(); ++r) {
+        prune_search(r, labels, hub_distance, distance, parent);
+    }
+    // Flat arrays from here on, no per node allocation to pay for
+    // and the labels of a node are contiguous for the merge
+    _offsets.reserve(_c.node_count() + 1);
+    _offsets.push_back(0);
+    for (auto& l: labels) {
+        _offsets.push_back(_offsets.back() + l.size());
+    }
+    _hubs.reserve(_offsets.back());
+    _distances.reserve(_offsets.back());
+    _parents.reserve(_offsets.back());
+    for (auto& l: labels) {
+        for (auto& e: l) {
+            _hubs.push_back(e.hub);
+            _distances.push_back(e.distance);
+            _parents.push_back(e.parent);
+        }
+        vector<label>().swap(l);
+    }
+    STATS_ADD(bytes_allocated, _offsets.size() * sizeof(size_t)
+                               + _hubs.size() * (sizeof(rank) + sizeof(int) + sizeof(csr::index)));
+}
+
+void hub_labels::prune_search(size_t hub, vector<vector<label>>& labels,
+                              vector<int>& hub_distance, vector<int>& distance,
+                              vector<csr::index>& parent)
+{
+    size_t source = _order[hub];
+    // Distances from the hub through the hubs already done, so that
+    // the pruning test below only walks the label of the other node
+    for (auto& e: labels[source]) {
+        hub_distance[e.hub] = e.distance;
+    }
+    typedef pair<int, size_t> entry;
+    auto order = [](const entry& e1, const entry& e2) {return e1.first > e2.first;};
+    vector<entry> open;
+    vector<size_t> reached;
+    distance[source] = 0;
+    reached.push_back(source);
+    parent[source] = source;
+    open.push_back({0, source});
+    while (!open.empty()) {
+        pop_heap(open.begin(), open.end(), order);
+        entry current = open.back();
+        open.pop_back();
+        size_t v = current.second;
+        if (current.first != distance[v]) {
+            continue; // Stale entry
+        }
+        STATS_ADD(nodes_settled, 1);
+        bool covered = false;
+        for (auto& e: labels[v]) {
+            if (hub_distance[e.hub] != unreachable
+                && hub_distance[e.hub] + e.distance <= current.first) {
+                covered = true;
+                break;
+            }
+        }
+        if (covered) {
+            // A more important hub already answers for v and for
+            // everything behind it
+            continue;
+        }
+        labels[v].push_back({static_cast<rank>(hub), current.first, parent[v]});
+        for (size_t a = _c.arc_begin(v); a < _c.arc_end(v); ++a) {
+            size_t t = _c.target(a);
+            int d = current.first + _c.cost(a);
+            STATS_ADD(edges_relaxed, 1);
+            if (d < distance[t]) {
+                if (distance[t] == unreachable) {
+                    reached.push_back(t);
+                }
+                distance[t] = d;
+                parent[t] = v;
+                open.push_back({d, t});
+                push_heap(open.begin(), open.end(), order);
+                STATS_ADD(heap_pushes, 1);
+            }
+        }
+    }
+    for (auto& e: labels[source]) {
+        hub_distance[e.hub] = unreachable;
+    }
+    for (auto i: reached) {
+        distance[i] = unreachable;
+    }
+}
+
+hub_labels::meeting hub_labels::meet(size_t x, size_t y) const
+{
+    meeting best = {0, 0, unreachable};
+    size_t i = _offsets[x];
+    size_t j = _offsets[y];
+    size_t x_end = _offsets[x + 1];
+    size_t y_end = _offsets[y + 1];
+    // Plain merge of two sorted lists, the labels are short enough
+    // that this beats anything fancier
+    while (i < x_end && j < y_end) {
+        if (_hubs[i] < _hubs[j]) {
+            ++i;
+        } else if (_hubs[i] > _hubs[j]) {
+            ++j;
+        } else {
+            int d = _distances[i] + _distances[j];
+            if (d < best.distance) {
+                best = {i, j, d};
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return best;
+}
+
+int hub_labels::distance(int x, int y) const
+{
+    size_t ix = _c.get_index(x);
+    size_t iy = _c.get_index(y);
+    if (ix == csr::npos || iy == csr::npos) {
+        return unreachable;
+    }
+    return meet(ix, iy).distance;
+}
+
+void hub_labels::walk_to_hub(size_t i, size_t entry, vector<int>& ids) const
+{
+    rank hub = _hubs[entry];
+    while (i != _order[hub]) {
+        ids.push_back(_c.get_id(i));
+        i = _parents[entry];
+        // The parent was expanded by the search of the same hub so
+        // its label has an entry for it
+        auto first = _hubs.begin() + _offsets[i];
+        auto last = _hubs.begin() + _offsets[i + 1];
+        entry = lower_bound(first, last, hub) - _hubs.begin();
+    }
+    ids.push_back(_c.get_id(i));
+}
+
+bool hub_labels::get_path(int x, int y, vector<int>& ids, int& cost) const
+{
+    ids.clear();
+    size_t ix = _c.get_index(x);
+    size_t iy = _c.get_index(y);
+    if (ix == csr::npos || iy == csr::npos) {
+        return false;
+    }
+    auto m = meet(ix, iy);
+    if (m.distance == unreachable) {
+        return false;
+    }
+    cost = m.distance;
+    // x up to the hub, then the way from y to the hub backwards
+    walk_to_hub(ix, m.in_x, ids);
+    vector<int> back;
+    walk_to_hub(iy, m.in_y, back);
+    back.pop_back(); // The hub is already there
+    ids.insert(ids.end(), back.rbegin(), back.rend());
+    return true;
+}
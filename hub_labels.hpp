@@ -0,0 +1,79 @@
+#ifndef __HUB_LABELS__
+#define __HUB_LABELS__
+
+// C++ includes
+#include "csr.hpp"
+#include "graph.hpp"
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint32_t
+
+// Exact distance oracle with pruned landmark labeling (PLL).
+//
+// Every node gets a label, a list of (hub, distance) pairs, such that
+// any two nodes share a hub on one of their shortest paths. A query
+// is then a merge of two short sorted lists instead of a lookup in
+// the O(V^2) tables of shortest_path, which stop fitting in memory
+// long before the labels do.
+//
+// The labels are built with one Dijkstra per node, highest degree
+// first since those sit on the most shortest paths. A search is
+// pruned at every node the labels built so far already answer for,
+// so later searches only visit a small corner of the graph. Every
+// entry also keeps the parent of the node in the search of its hub,
+// which is enough to walk back to the hub and rebuild the path.
+//
+// Like Dijkstra it needs non negative costs, the constructor throws
+// runtime_error otherwise. The oracle does not follow later changes
+// to the graph and only talks in node ids.
+class hub_labels
+{
+    public:
+        static const int unreachable;
+
+        explicit hub_labels(graph& g);
+        hub_labels(const hub_labels&) = delete;
+        hub_labels& operator=(const hub_labels&) = delete;
+
+        size_t node_count() const {return _c.node_count();}
+        // Total number of (hub, distance) pairs, the memory is linear in it
+        size_t label_count() const {return _hubs.size();}
+        // unreachable when there is no path or a node is unknown
+        int distance(int x, int y) const;
+        // Cheapest path from x to y as a list of ids starting with x.
+        // Returns false when y cannot be reached from x.
+        bool get_path(int x, int y, std::vector<int>& ids, int& cost) const;
+    private:
+        typedef uint32_t rank;
+        struct label
+        {
+            rank hub;
+            int distance;
+            csr::index parent;
+        };
+        // Position in the labels of x and y of their best common hub
+        struct meeting
+        {
+            size_t in_x;
+            size_t in_y;
+            int distance;
+        };
+        meeting meet(size_t x, size_t y) const;
+        void prune_search(size_t hub, std::vector<std::vector<label>>& labels,
+                          std::vector<int>& hub_distance, std::vector<int>& distance,
+                          std::vector<csr::index>& parent);
+        void walk_to_hub(size_t i, size_t entry, std::vector<int>& ids) const;
+        csr _c;
+        // Nodes by decreasing degree, a hub is stored as its rank here
+        std::vector<csr::index> _order;
+        // Labels of all the nodes back to back, sorted by hub rank,
+        // the label of node i is [_offsets[i], _offsets[i + 1])
+        std::vector<size_t> _offsets;
+        std::vector<rank> _hubs;
+        std::vector<int> _distances;
+        std::vector<csr::index> _parents;
+};
+
+#endif // __HUB_LABELS__
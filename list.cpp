@@ -1,13 +1,31 @@
 // C++ headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // C headers
 #include <cstdlib>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 
-using namespace std;
+// Not the whole of std, std::list would clash with our list
+using std::cout;
+using std::endl;
+using std::forward_iterator_tag;
+using std::milli;
+using std::ostream;
+using std::string;
+namespace chrono = std::chrono;
 
 class list_element
 {
@@ -153,13 +171,11 @@ list::~list()
     delete &prev;
 }
 
-list::list(const char* arr, size_t n)
+list::list(const char* arr, size_t n): head(nullptr), tail(nullptr)
 {
     if (!arr || !n) {
         return;
     }
-    head = nullptr;
-    tail = nullptr;
     for (size_t i = 0; i < n; ++i) {
         this->push_back(arr[i]);
     }
@@ -174,8 +190,1047 @@ list::list(const list& other)
     }
 }
 
-int main()
+// Same list of chars but unrolled: every node (chunk) holds as many
+// chars as fit in a cache line next to the link and the count, so a
+// char costs a byte instead of the 16 of a list_element and walking
+// the list touches one cache line per 55 chars instead of one per char.
+// Chunks come from a free list cached per thread, which trades batches
+// with a shared pool that carves them out of big slabs, so building a
+// list goes neither through new nor through a lock for every chunk. Chunks do not have to be full, which is
+// what makes splice O(1): the chunks of the other list are just linked
+// after ours.
+class unrolled_list
+{
+    private:
+        struct chunk;
+    public:
+        static const size_t chunk_size = 64;
+
+        unrolled_list(): head(nullptr), tail(nullptr), count(0){};
+        unrolled_list(const char* arr, size_t n);
+        unrolled_list(const unrolled_list& other);
+        unrolled_list(unrolled_list&& other);
+        unrolled_list& operator=(unrolled_list other);
+        ~unrolled_list();
+        void push_front(int n);
+        void push_back(int n);
+        // memcpy into the free room of the last chunk then into new chunks
+        void append(const char* arr, size_t n);
+        // Moves every element of other at the end of this list
+        void splice(unrolled_list& other);
+        void swap(unrolled_list& other);
+        size_t size() const {return count;}
+        friend ostream& operator<<(ostream& out, unrolled_list& l);
+        class iterator : public std::iterator<forward_iterator_tag, char>
+        {
+            public:
+                iterator(chunk* cursor = nullptr, size_t index = 0):cursor(cursor), index(index){};
+                bool operator==(const iterator& iter) const {return cursor == iter.cursor && index == iter.index;}
+                bool operator!=(const iterator& iter) const {return !(*this == iter);}
+                iterator& operator++()
+                {
+                    if (cursor && ++index == cursor->count) {
+                        cursor = cursor->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+                reference operator*() const {return cursor->data[index];}
+                pointer operator->() const {return &cursor->data[index];}
+            private:
+                chunk* cursor;
+                size_t index;
+        };
+        class const_iterator : public std::iterator<forward_iterator_tag, const char>
+        {
+            public:
+                const_iterator(const chunk* cursor = nullptr, size_t index = 0):cursor(cursor), index(index){};
+                bool operator==(const const_iterator& iter) const {return cursor == iter.cursor && index == iter.index;}
+                bool operator!=(const const_iterator& iter) const {return !(*this == iter);}
+                const_iterator& operator++()
+                {
+                    if (cursor && ++index == cursor->count) {
+                        cursor = cursor->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+                reference operator*() const {return cursor->data[index];}
+                pointer operator->() const {return &cursor->data[index];}
+            private:
+                const chunk* cursor;
+                size_t index;
+        };
+        iterator begin(){return iterator(head);}
+        iterator end(){return iterator();}
+        const_iterator begin() const {return const_iterator(head);}
+        const_iterator end() const {return const_iterator();}
+    private:
+        // Never empty once in a list, the iterators count on it
+        struct chunk
+        {
+            chunk* next;
+            uint8_t count;
+            char data[chunk_size - sizeof(chunk*) - sizeof(uint8_t)];
+        };
+        static const size_t capacity = sizeof(chunk::data);
+        // Chunks are carved out of slabs of slab_size and trade
+        // between the threads batch_size at a time. A list is not
+        // thread safe but two lists on two threads must be, and a list
+        // may well be freed by another thread than the one that built it.
+        static const size_t batch_size = 64;
+        class pool
+        {
+            public:
+                static const size_t slab_size = 256;
+                pool(): free(nullptr), count(0), slabs(){};
+                void get_batch(chunk*& chain, size_t& n);
+                void put_batch(chunk* chain, size_t n);
+            private:
+                std::mutex lock;
+                chunk* free;
+                size_t count;
+                std::vector<std::unique_ptr<chunk[]>> slabs;
+        };
+        // Free chunks of the calling thread
+        struct cache
+        {
+            chunk* free;
+            size_t count;
+            cache(): free(nullptr), count(0){};
+            ~cache();
+        };
+        static pool& chunks();
+        static cache& local_cache();
+        static void release(chunk* c);
+        chunk* new_chunk(chunk* next = nullptr);
+        chunk* head;
+        chunk* tail;
+        size_t count;
+};
+
+void unrolled_list::pool::get_batch(chunk*& chain, size_t& n)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (!free) {
+        slabs.push_back(std::unique_ptr<chunk[]>(new chunk[slab_size]));
+        chunk* slab = slabs.back().get();
+        for (size_t i = 0; i < slab_size; ++i) {
+            slab[i].next = free;
+            free = &slab[i];
+        }
+        count += slab_size;
+    }
+    chain = free;
+    n = 0;
+    chunk* last = nullptr;
+    while (free && n < batch_size) {
+        last = free;
+        free = free->next;
+        ++n;
+    }
+    last->next = nullptr;
+    count -= n;
+}
+
+void unrolled_list::pool::put_batch(chunk* chain, size_t n)
+{
+    if (!chain) {
+        return;
+    }
+    chunk* last = chain;
+    while (last->next) {
+        last = last->next;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    last->next = free;
+    free = chain;
+    count += n;
+}
+
+unrolled_list::cache::~cache()
+{
+    chunks().put_batch(free, count);
+}
+
+unrolled_list::pool& unrolled_list::chunks()
+{
+    static pool p;
+    return p;
+}
+
+unrolled_list::cache& unrolled_list::local_cache()
+{
+    static thread_local cache c;
+    return c;
+}
+
+void unrolled_list::release(chunk* c)
+{
+    auto& local = local_cache();
+    c->next = local.free;
+    local.free = c;
+    ++local.count;
+    if (local.count >= 2 * batch_size) {
+        // Keep one batch, a thread that only frees lists built by
+        // others would otherwise hoard their chunks
+        chunk* chain = local.free;
+        chunk* last = chain;
+        for (size_t i = 1; i < batch_size; ++i) {
+            last = last->next;
+        }
+        local.free = last->next;
+        last->next = nullptr;
+        local.count -= batch_size;
+        chunks().put_batch(chain, batch_size);
+    }
+}
+
+unrolled_list::chunk* unrolled_list::new_chunk(chunk* next)
+{
+    auto& local = local_cache();
+    if (!local.free) {
+        chunks().get_batch(local.free, local.count);
+    }
+    chunk* c = local.free;
+    local.free = c->next;
+    --local.count;
+    c->next = next;
+    c->count = 0;
+    return c;
+}
+
+void unrolled_list::push_front(int n)
+{
+    if (!head || head->count == capacity) {
+        head = new_chunk(head);
+        if (!tail) {
+            tail = head;
+        }
+    }
+    memmove(head->data + 1, head->data, head->count);
+    head->data[0] = n;
+    ++head->count;
+    ++count;
+}
+
+void unrolled_list::push_back(int n)
+{
+    if (!tail || tail->count == capacity) {
+        chunk* c = new_chunk();
+        if (tail) {
+            tail->next = c;
+        } else {
+            head = c;
+        }
+        tail = c;
+    }
+    tail->data[tail->count++] = n;
+    ++count;
+}
+
+void unrolled_list::append(const char* arr, size_t n)
+{
+    count += n;
+    while (n) {
+        if (!tail || tail->count == capacity) {
+            chunk* c = new_chunk();
+            if (tail) {
+                tail->next = c;
+            } else {
+                head = c;
+            }
+            tail = c;
+        }
+        size_t room = capacity - tail->count;
+        size_t copy = n < room ? n : room;
+        memcpy(tail->data + tail->count, arr, copy);
+        tail->count += copy;
+        arr += copy;
+        n -= copy;
+    }
+}
+
+void unrolled_list::splice(unrolled_list& other)
+{
+    if (&other == this || !other.head) {
+        return;
+    }
+    if (tail) {
+        tail->next = other.head;
+    } else {
+        head = other.head;
+    }
+    tail = other.tail;
+    count += other.count;
+    other.head = other.tail = nullptr;
+    other.count = 0;
+}
+
+void unrolled_list::swap(unrolled_list& other)
+{
+    std::swap(head, other.head);
+    std::swap(tail, other.tail);
+    std::swap(count, other.count);
+}
+
+ostream& operator<<(ostream& out, unrolled_list& l)
+{
+    for (auto e: l) {
+        out << e << " ";
+    }
+    return out;
+}
+
+unrolled_list::~unrolled_list()
+{
+    while (head) {
+        chunk* next = head->next;
+        release(head);
+        head = next;
+    }
+}
+
+unrolled_list::unrolled_list(const char* arr, size_t n): head(nullptr), tail(nullptr), count(0)
+{
+    if (arr) {
+        append(arr, n);
+    }
+}
+
+unrolled_list::unrolled_list(const unrolled_list& other): head(nullptr), tail(nullptr), count(0)
+{
+    // A chunk at a time, the copy ends up packed
+    for (const chunk* c = other.head; c; c = c->next) {
+        append(c->data, c->count);
+    }
+}
+
+unrolled_list::unrolled_list(unrolled_list&& other): head(other.head), tail(other.tail), count(other.count)
+{
+    other.head = other.tail = nullptr;
+    other.count = 0;
+}
+
+unrolled_list& unrolled_list::operator=(unrolled_list other)
+{
+    // Copy (or move) and swap, the old chunks go with other
+    swap(other);
+    return *this;
+}
+
+// Lock free queue of chars for handing data over between threads,
+// list itself has no synchronization at all.
+//
+// push() and pop() are Michael and Scott's queue: a dummy element at
+// the head, producers link their element after the last one with a
+// compare and swap on its next and then swing tail, helping a lagging
+// tail along when they find one. Any number of threads may push and
+// pop at the same time. drain() is for a single consumer (no pop() or
+// drain() running alongside it): it takes the tail it sees as the new
+// dummy, which detaches everything before it in one store, then walks
+// the detached chain without looking at any other thread. A lagging
+// tail gets one push along first; anything linked later waits for the
+// next drain, so a drain is wait-free however fast producers push.
+//
+// An element that leaves the queue may still be looked at by a thread
+// that read a pointer to it just before, so it is retired rather than
+// freed: every thread publishes the (at most two) elements it is about
+// to dereference as hazard pointers, and retired elements are only
+// recycled once no hazard pointer points to them (Michael's hazard
+// pointers). Recycled elements go to a free list cached per thread
+// which trades batches with a shared pool, so neither a push nor a pop
+// usually goes anywhere near new or a lock.
+class concurrent_list
+{
+    public:
+        concurrent_list();
+        concurrent_list(const concurrent_list&) = delete;
+        concurrent_list& operator=(const concurrent_list&) = delete;
+        // Not safe with other threads still using the list
+        ~concurrent_list();
+        void push_back(int n);
+        // False when the list was empty
+        bool pop_front(char& d);
+        // Calls f on every element in order, returns how many
+        template <typename F>
+        size_t drain(F f);
+        bool empty() const;
+    private:
+        struct element
+        {
+            char d;
+            std::atomic<element*> next;
+        };
+        // Elements are carved out of slabs of batch_size and trade
+        // between the threads batch_size at a time
+        static const size_t batch_size = 64;
+        class pool
+        {
+            public:
+                pool(): free(nullptr), count(0), slabs(){};
+                void get_batch(element*& chain, size_t& n);
+                void put_batch(element* chain, size_t n);
+            private:
+                std::mutex lock;
+                element* free;
+                size_t count;
+                std::vector<std::unique_ptr<element[]>> slabs;
+        };
+        // Free list of the calling thread
+        struct cache
+        {
+            element* free;
+            size_t count;
+            cache(): free(nullptr), count(0){};
+            ~cache();
+        };
+        struct hazard_record
+        {
+            std::atomic<element*> hazard[2];
+            std::atomic<bool> active;
+            hazard_record* next;
+            // Left to the next owner when the thread exits
+            std::vector<element*> retired;
+        };
+        // Frees the records at exit
+        struct registry
+        {
+            std::atomic<hazard_record*> records;
+            std::atomic<size_t> count;
+            registry(): records(nullptr), count(0){};
+            ~registry();
+        };
+        // Gives the record back when the thread exits
+        struct record_holder
+        {
+            hazard_record* record;
+            record_holder();
+            ~record_holder();
+        };
+        static pool& elements();
+        static registry& hazards();
+        static cache& local_cache();
+        static hazard_record& local_record();
+        static element* new_element(char d);
+        static void recycle(element* e);
+        // Publishes the value of p as hazard pointer slot and returns
+        // it once it is sure p did not change meanwhile
+        static element* protect(const std::atomic<element*>& p, size_t slot);
+        static void clear_hazards();
+        static void retire(element* e);
+        static void scan(hazard_record& r);
+        std::atomic<element*> head;
+        std::atomic<element*> tail;
+};
+
+void concurrent_list::pool::get_batch(element*& chain, size_t& n)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (!free) {
+        slabs.push_back(std::unique_ptr<element[]>(new element[batch_size]));
+        element* slab = slabs.back().get();
+        for (size_t i = 0; i < batch_size; ++i) {
+            slab[i].next.store(free, std::memory_order_relaxed);
+            free = &slab[i];
+        }
+        count += batch_size;
+    }
+    chain = free;
+    n = 0;
+    element* last = nullptr;
+    while (free && n < batch_size) {
+        last = free;
+        free = free->next.load(std::memory_order_relaxed);
+        ++n;
+    }
+    last->next.store(nullptr, std::memory_order_relaxed);
+    count -= n;
+}
+
+void concurrent_list::pool::put_batch(element* chain, size_t n)
 {
+    if (!chain) {
+        return;
+    }
+    element* last = chain;
+    while (last->next.load(std::memory_order_relaxed)) {
+        last = last->next.load(std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    last->next.store(free, std::memory_order_relaxed);
+    free = chain;
+    count += n;
+}
+
+concurrent_list::cache::~cache()
+{
+    elements().put_batch(free, count);
+}
+
+concurrent_list::registry::~registry()
+{
+    hazard_record* r = records.load();
+    while (r) {
+        hazard_record* next = r->next;
+        delete r;
+        r = next;
+    }
+}
+
+concurrent_list::record_holder::record_holder(): record(nullptr)
+{
+    auto& h = hazards();
+    // Reuse the record of a thread that is gone
+    for (hazard_record* r = h.records.load(); r; r = r->next) {
+        bool idle = false;
+        if (r->active.compare_exchange_strong(idle, true)) {
+            record = r;
+            return;
+        }
+    }
+    record = new hazard_record();
+    record->hazard[0].store(nullptr);
+    record->hazard[1].store(nullptr);
+    record->active.store(true);
+    hazard_record* first = h.records.load();
+    do {
+        record->next = first;
+    } while (!h.records.compare_exchange_weak(first, record));
+    ++h.count;
+}
+
+concurrent_list::record_holder::~record_holder()
+{
+    record->hazard[0].store(nullptr);
+    record->hazard[1].store(nullptr);
+    record->active.store(false);
+}
+
+concurrent_list::pool& concurrent_list::elements()
+{
+    static pool p;
+    return p;
+}
+
+concurrent_list::registry& concurrent_list::hazards()
+{
+    static registry r;
+    return r;
+}
+
+concurrent_list::cache& concurrent_list::local_cache()
+{
+    static thread_local cache c;
+    return c;
+}
+
+concurrent_list::hazard_record& concurrent_list::local_record()
+{
+    static thread_local record_holder holder;
+    return *holder.record;
+}
+
+concurrent_list::element* concurrent_list::new_element(char d)
+{
+    auto& c = local_cache();
+    if (!c.free) {
+        elements().get_batch(c.free, c.count);
+    }
+    element* e = c.free;
+    c.free = e->next.load(std::memory_order_relaxed);
+    --c.count;
+    e->d = d;
+    e->next.store(nullptr, std::memory_order_relaxed);
+    return e;
+}
+
+void concurrent_list::recycle(element* e)
+{
+    auto& c = local_cache();
+    e->next.store(c.free, std::memory_order_relaxed);
+    c.free = e;
+    ++c.count;
+    if (c.count >= 2 * batch_size) {
+        // Keep one batch, the consumer frees what producers allocate
+        // so without this its cache would only grow
+        element* chain = c.free;
+        element* last = chain;
+        for (size_t i = 1; i < batch_size; ++i) {
+            last = last->next.load(std::memory_order_relaxed);
+        }
+        c.free = last->next.load(std::memory_order_relaxed);
+        last->next.store(nullptr, std::memory_order_relaxed);
+        c.count -= batch_size;
+        elements().put_batch(chain, batch_size);
+    }
+}
+
+concurrent_list::element* concurrent_list::protect(const std::atomic<element*>& p, size_t slot)
+{
+    auto& r = local_record();
+    element* e = p.load();
+    for (;;) {
+        r.hazard[slot].store(e);
+        element* again = p.load();
+        if (again == e) {
+            return e;
+        }
+        e = again;
+    }
+}
+
+void concurrent_list::clear_hazards()
+{
+    auto& r = local_record();
+    r.hazard[0].store(nullptr, std::memory_order_release);
+    r.hazard[1].store(nullptr, std::memory_order_release);
+}
+
+void concurrent_list::retire(element* e)
+{
+    auto& r = local_record();
+    r.retired.push_back(e);
+    // Amortized: every scan frees at least half of what it looks at
+    if (r.retired.size() >= 2 * 2 * hazards().count.load() + batch_size) {
+        scan(r);
+    }
+}
+
+void concurrent_list::scan(hazard_record& r)
+{
+    std::vector<element*> hazarded;
+    for (hazard_record* h = hazards().records.load(); h; h = h->next) {
+        for (auto& p: h->hazard) {
+            element* e = p.load();
+            if (e) {
+                hazarded.push_back(e);
+            }
+        }
+    }
+    std::sort(hazarded.begin(), hazarded.end());
+    std::vector<element*> kept;
+    for (auto e: r.retired) {
+        if (std::binary_search(hazarded.begin(), hazarded.end(), e)) {
+            kept.push_back(e);
+        } else {
+            recycle(e);
+        }
+    }
+    r.retired.swap(kept);
+}
+
+concurrent_list::concurrent_list(): head(nullptr), tail(nullptr)
+{
+    element* dummy = new_element(0);
+    head.store(dummy);
+    tail.store(dummy);
+}
+
+concurrent_list::~concurrent_list()
+{
+    element* e = head.load();
+    while (e) {
+        element* next = e->next.load();
+        recycle(e);
+        e = next;
+    }
+}
+
+void concurrent_list::push_back(int n)
+{
+    element* e = new_element(n);
+    for (;;) {
+        element* last = protect(tail, 0);
+        element* next = last->next.load();
+        if (last != tail.load()) {
+            continue;
+        }
+        if (next) {
+            // Someone linked an element but did not swing tail yet
+            tail.compare_exchange_weak(last, next);
+            continue;
+        }
+        if (last->next.compare_exchange_weak(next, e)) {
+            tail.compare_exchange_strong(last, e);
+            break;
+        }
+    }
+    clear_hazards();
+}
+
+bool concurrent_list::pop_front(char& d)
+{
+    for (;;) {
+        element* first = protect(head, 0);
+        element* last = tail.load();
+        element* next = protect(first->next, 1);
+        if (first != head.load()) {
+            continue;
+        }
+        if (!next) {
+            clear_hazards();
+            return false;
+        }
+        if (first == last) {
+            tail.compare_exchange_weak(last, next);
+            continue;
+        }
+        // next becomes the dummy, its value is ours if we get there first
+        char value = next->d;
+        if (head.compare_exchange_weak(first, next)) {
+            clear_hazards();
+            d = value;
+            retire(first);
+            return true;
+        }
+    }
+}
+
+template <typename F>
+size_t concurrent_list::drain(F f)
+{
+    // Everything up to tail is linked already, tail only ever moves
+    // forward to an element after it was linked, so head set to a tail
+    // we saw never gets past tail. One helping swing for a lagging
+    // tail, after which tail is at least its successor too; whatever
+    // is linked beyond that is left for the next drain.
+    element* first = head.load();
+    element* last = tail.load();
+    element* next = last->next.load();
+    if (next) {
+        element* expected = last;
+        tail.compare_exchange_strong(expected, next);
+        last = next;
+    }
+    if (first == last) {
+        return 0;
+    }
+    head.store(last);
+    size_t n = 0;
+    for (element* e = first; e != last;) {
+        element* next = e->next.load();
+        f(next->d);
+        ++n;
+        retire(e);
+        e = next;
+    }
+    return n;
+}
+
+bool concurrent_list::empty() const
+{
+    bool none = protect(head, 0)->next.load() == nullptr;
+    clear_hazards();
+    return none;
+}
+
+// Time f in milliseconds
+template <typename F>
+static double measure(F f)
+{
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Build, walk, copy and bulk load the three layouts with the same
+// data, usage: list --bench [elements]
+template <typename List>
+static void bench_layout(const char* name, const string& data, size_t rounds)
+{
+    volatile long sum = 0;
+    double build = 0.0;
+    double walk = 0.0;
+    double copy = 0.0;
+    double bulk = 0.0;
+    for (size_t r = 0; r < rounds; ++r) {
+        std::unique_ptr<List> l(new List());
+        build += measure([&]() {
+            for (auto c: data) {
+                l->push_back(c);
+            }
+        });
+        walk += measure([&]() {
+            long s = 0;
+            for (auto& e: *l) {
+                s += reinterpret_cast<const char&>(e);
+            }
+            sum = s;
+        });
+        copy += measure([&]() {List other(*l);});
+        bulk += measure([&]() {List other(data.data(), data.size());});
+    }
+    cout << name << ": push_back " << build / rounds << " ms, walk " << walk / rounds
+         << " ms, copy " << copy / rounds << " ms, from array " << bulk / rounds << " ms" << endl;
+}
+
+// std::list has no constructor from a char array
+class std_list : public std::list<char>
+{
+    public:
+        std_list() {}
+        std_list(const char* arr, size_t n) : std::list<char>(arr, arr + n) {}
+};
+
+static void bench(size_t n)
+{
+    string data(n, ' ');
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = 'a' + i % 26;
+    }
+    cout << n << " elements" << endl;
+    bench_layout<list>("list", data, 5);
+    bench_layout<unrolled_list>("unrolled_list", data, 5);
+    bench_layout<std_list>("std::list", data, 5);
+}
+
+// Producers push n chars between them while a single consumer drains,
+// usage: list --bench-queue [elements]
+static void bench_queue(size_t n)
+{
+    cout << n << " elements" << endl;
+    for (size_t producers = 1; producers <= 32; producers *= 2) {
+        concurrent_list q;
+        size_t each = n / producers;
+        long expected = 0;
+        for (size_t i = 0; i < each; ++i) {
+            expected += i % 100;
+        }
+        expected *= producers;
+        long sum = 0;
+        size_t received = 0;
+        double ms = measure([&]() {
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < producers; ++p) {
+                threads.push_back(std::thread([&]() {
+                    for (size_t i = 0; i < each; ++i) {
+                        q.push_back(i % 100);
+                    }
+                }));
+            }
+            while (received < each * producers) {
+                received += q.drain([&](char d) {sum += d;});
+            }
+            for (auto& t: threads) {
+                t.join();
+            }
+        });
+        cout << producers << " producers: " << (received / ms) / 1000 << " M/s"
+             << (sum == expected ? "" : " (lost elements)") << endl;
+    }
+}
+
+// Self checks, there is no test suite for the lists. Returns the
+// number of failures, usage: list --check
+static size_t failures = 0;
+
+static void check(bool ok, const char* what, size_t n)
+{
+    if (!ok) {
+        cout << "FAILED: " << what << " (" << n << " elements)" << endl;
+        ++failures;
+    }
+}
+
+static string contents(const unrolled_list& l)
+{
+    return string(l.begin(), l.end());
+}
+
+// Splice, copy and append round trip, sizes around the chunk capacity
+// so that every path through append and splice gets its turn
+static void check_unrolled_round_trip(size_t n)
+{
+    string data(n, ' ');
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = 'a' + i % 26;
+    }
+    unrolled_list l(data.data(), n);
+    check(contents(l) == data && l.size() == n, "build from array", n);
+    unrolled_list copy(l);
+    check(contents(copy) == data && copy.size() == n, "copy", n);
+    l.append(data.data(), n);
+    check(contents(l) == data + data && l.size() == 2 * n, "append", n);
+    l.splice(copy);
+    check(contents(l) == data + data + data && l.size() == 3 * n, "splice", n);
+    check(contents(copy).empty() && copy.size() == 0, "spliced list is empty", n);
+    // A spliced list takes more and the chunks it gave away stay put
+    copy.append(data.data(), n);
+    copy.push_front('<');
+    copy.push_back('>');
+    check(contents(copy) == "<" + data + ">", "reuse after splice", n);
+    check(contents(l) == data + data + data, "splice is not aliased", n);
+    unrolled_list assigned;
+    assigned = l;
+    l.splice(assigned);
+    check(contents(l) == data + data + data + data + data + data, "assign then splice", n);
+}
+
+// Lists built, copied and freed on several threads at once, and lists
+// built on one thread and freed on another, all sharing the pool
+static void check_unrolled_threads()
+{
+    const size_t threads = 4;
+    const size_t rounds = 2000;
+    string data(300, ' ');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = 'a' + i % 26;
+    }
+    std::vector<std::unique_ptr<unrolled_list>> handed(threads);
+    std::atomic<size_t> bad(0);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            for (size_t r = 0; r < rounds; ++r) {
+                unrolled_list l(data.data(), r % data.size());
+                unrolled_list copy(l);
+                l.splice(copy);
+                if (l.size() != 2 * (r % data.size())) {
+                    ++bad;
+                }
+            }
+            handed[t].reset(new unrolled_list(data.data(), data.size()));
+        }));
+    }
+    for (auto& w: workers) {
+        w.join();
+    }
+    workers.clear();
+    for (size_t t = 0; t < threads; ++t) {
+        // Freed by the next thread along, not the one that built it
+        workers.push_back(std::thread([&, t]() {
+            auto& l = handed[(t + 1) % threads];
+            if (contents(*l) != data) {
+                ++bad;
+            }
+            l.reset();
+        }));
+    }
+    for (auto& w: workers) {
+        w.join();
+    }
+    check(bad == 0, "lists on several threads", data.size());
+}
+
+// Producer p pushes p * 64 + i % 64 for i below each, so with at most
+// 4 producers every (producer, i % 64) is a char of its own
+static const size_t residues = 64;
+
+static char encode(size_t p, size_t i)
+{
+    return static_cast<char>(p * residues + i % residues);
+}
+
+// Several producers and several consumers popping at the same time,
+// every element must come out exactly once
+static void check_concurrent_pop()
+{
+    const size_t producers = 4;
+    const size_t consumers = 3;
+    const size_t each = residues * 1600;
+    concurrent_list q;
+    std::vector<std::atomic<size_t>> seen(producers * residues);
+    for (auto& s: seen) {
+        s.store(0);
+    }
+    std::atomic<size_t> received(0);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&, p]() {
+            for (size_t i = 0; i < each; ++i) {
+                q.push_back(encode(p, i));
+            }
+        }));
+    }
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.push_back(std::thread([&]() {
+            char d;
+            while (received.load() < producers * each) {
+                if (q.pop_front(d)) {
+                    ++seen[static_cast<unsigned char>(d)];
+                    ++received;
+                }
+            }
+        }));
+    }
+    for (auto& t: threads) {
+        t.join();
+    }
+    bool once = true;
+    for (auto& s: seen) {
+        once = once && s.load() == each / residues;
+    }
+    check(once && q.empty(), "pop_front delivers exactly once", producers * each);
+}
+
+// Producers keep pushing while a single consumer drains, elements
+// pushed during a drain must come out of this drain or a later one,
+// once and in the order of their producer
+static void check_concurrent_drain()
+{
+    const size_t producers = 4;
+    const size_t each = residues * 1600;
+    concurrent_list q;
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&, p]() {
+            for (size_t i = 0; i < each; ++i) {
+                q.push_back(encode(p, i));
+            }
+        }));
+    }
+    std::vector<size_t> next(producers, 0);
+    bool ordered = true;
+    size_t received = 0;
+    while (received < producers * each) {
+        received += q.drain([&](char d) {
+            size_t v = static_cast<unsigned char>(d);
+            size_t p = v / residues;
+            ordered = ordered && p < producers && v % residues == next[p] % residues;
+            if (p < producers) {
+                ++next[p];
+            }
+        });
+    }
+    for (auto& t: threads) {
+        t.join();
+    }
+    for (auto n: next) {
+        ordered = ordered && n == each;
+    }
+    check(ordered && q.empty() && q.drain([](char) {}) == 0,
+          "drain delivers exactly once", producers * each);
+}
+
+static size_t self_check()
+{
+    failures = 0;
+    const size_t capacity = unrolled_list::chunk_size - sizeof(void*) - 1;
+    for (size_t n: {size_t(0), size_t(1), capacity - 1, capacity, capacity + 1,
+                    2 * capacity, size_t(1000)}) {
+        check_unrolled_round_trip(n);
+    }
+    check_unrolled_threads();
+    check_concurrent_pop();
+    check_concurrent_drain();
+    cout << (failures ? "self check failed" : "self check passed") << endl;
+    return failures;
+}
+
+int main(int ac, char** av)
+{
+    if (ac > 1 && string(av[1]) == "--bench") {
+        bench(ac > 2 ? strtoul(av[2], nullptr, 10) : 1000000);
+        return EXIT_SUCCESS;
+    }
+    if (ac > 1 && string(av[1]) == "--bench-queue") {
+        bench_queue(ac > 2 ? strtoul(av[2], nullptr, 10) : 4000000);
+        return EXIT_SUCCESS;
+    }
+    if (ac > 1 && string(av[1]) == "--check") {
+        return self_check() ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
     list l;
     l.push_front('e');
     l.push_front('n');
@@ -188,5 +1243,22 @@ int main()
     const char* arr = "Amine";
     list l3(arr, strlen(arr));
     cout << l3 << endl;
+    unrolled_list l4(arr, strlen(arr));
+    unrolled_list l5(l4);
+    l4.splice(l5);
+    l4.push_front('>');
+    cout << l4 << endl;
+    concurrent_list l6;
+    std::thread producer([&]() {
+        for (size_t i = 0; i < strlen(arr); ++i) {
+            l6.push_back(arr[i]);
+        }
+    });
+    producer.join();
+    char first;
+    l6.pop_front(first);
+    cout << first << " ";
+    l6.drain([](char d) {cout << d << " ";});
+    cout << endl;
     return EXIT_SUCCESS;
 }
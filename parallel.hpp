@@ -0,0 +1,97 @@
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+// C++ includes
+#include "executor.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>       // For shared_ptr
+#include <mutex>
+#include <thread>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Number of worker threads to use when the caller did not ask for
+// a specific count. hardware_concurrency() is allowed to return 0
+// when it cannot tell so we never go below one.
+inline size_t default_threads()
+{
+    size_t n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// Workers shared by every parallel_for, started on first use. Creating
+// and joining threads for every BFS level or delta-stepping phase would
+// cost more than the level itself on graphs with many of them.
+inline executor& parallel_pool()
+{
+    static executor pool;
+    return pool;
+}
+
+// Split [begin, end) in contiguous chunks and run f(lo, hi) on each
+// chunk. The chunks go to whoever asks first: the calling thread and
+// threads - 1 helpers queued on parallel_pool(). The caller keeps
+// taking chunks until none is left, so a nested call from a pool
+// worker never waits for a helper that cannot start, and a single
+// threaded run never involves the pool. Ranges smaller than
+// threads * grain are not worth the hand over and run inline.
+template <typename F>
+void parallel_for(size_t begin, size_t end, size_t threads, F f, size_t grain = 64)
+{
+    if (end <= begin) {
+        return;
+    }
+    if (!threads) {
+        threads = default_threads();
+    }
+    size_t count = end - begin;
+    if (threads > count / grain) {
+        threads = count / grain;
+    }
+    if (threads <= 1) {
+        f(begin, end);
+        return;
+    }
+    struct state
+    {
+        std::atomic<size_t> next;   // Next chunk to hand out
+        std::atomic<size_t> left;   // Chunks not done yet
+        std::mutex lock;
+        std::condition_variable done;
+    };
+    auto shared = std::make_shared<state>();
+    size_t chunk = (count + threads - 1) / threads;
+    size_t chunks = (count + chunk - 1) / chunk;
+    shared->next.store(0);
+    shared->left.store(chunks);
+    F* body = &f;
+    // A helper that starts after every chunk was taken returns without
+    // touching f, which may be gone by then
+    auto work = [shared, body, begin, end, chunk, chunks]()
+    {
+        for (;;) {
+            size_t c = shared->next++;
+            if (c >= chunks) {
+                return;
+            }
+            size_t lo = begin + c * chunk;
+            size_t hi = (lo + chunk < end) ? lo + chunk : end;
+            (*body)(lo, hi);
+            if (--shared->left == 0) {
+                std::lock_guard<std::mutex> guard(shared->lock);
+                shared->done.notify_all();
+            }
+        }
+    };
+    auto& pool = parallel_pool();
+    for (size_t t = 0; t + 1 < chunks; ++t) {
+        pool.submit(work);
+    }
+    work();
+    std::unique_lock<std::mutex> guard(shared->lock);
+    shared->done.wait(guard, [&]() {return shared->left.load() == 0;});
+}
+
+#endif // __PARALLEL__
@@ -0,0 +1,100 @@
+#include "partition.hpp"
+#include "csr.hpp"
+
+#include <vector>
+
+using namespace std;
+
+unordered_map<int, size_t> partition_graph(graph& g, size_t parts, size_t rounds)
+{
+    csr c(g);
+    size_t n = c.node_count();
+    if (!parts) {
+        parts = 1;
+    }
+    // Breadth first order, component after component
+    vector<size_t> order;
+    vector<bool> visited(n, false);
+    order.reserve(n);
+    for (size_t root = 0; root < n; ++root) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            size_t v = order[head++];
+            for (auto a: c.arcs(v)) {
+                if (!visited[a.target]) {
+                    visited[a.target] = true;
+                    order.push_back(a.target);
+                }
+            }
+        }
+    }
+    vector<size_t> label(n);
+    vector<size_t> size(parts, 0);
+    for (size_t k = 0; k < n; ++k) {
+        label[order[k]] = k * parts / n;
+        ++size[label[order[k]]];
+    }
+
+    size_t capacity = n / parts + n / parts / 20 + 1;
+    vector<size_t> count(parts, 0);
+    vector<size_t> seen;
+    for (size_t r = 0; r < rounds; ++r) {
+        size_t moved = 0;
+        for (auto v: order) {
+            seen.clear();
+            for (auto a: c.arcs(v)) {
+                if (a.target == v) {
+                    continue;
+                }
+                size_t l = label[a.target];
+                if (!count[l]++) {
+                    seen.push_back(l);
+                }
+            }
+            size_t current = label[v];
+            size_t best = current;
+            for (auto l: seen) {
+                if (count[l] > count[best] && size[l] < capacity) {
+                    best = l;
+                }
+            }
+            for (auto l: seen) {
+                count[l] = 0;
+            }
+            if (best != current) {
+                --size[current];
+                ++size[best];
+                label[v] = best;
+                ++moved;
+            }
+        }
+        if (!moved) {
+            break;
+        }
+    }
+
+    unordered_map<int, size_t> part;
+    for (size_t i = 0; i < n; ++i) {
+        part[c.get_id(i)] = label[i];
+    }
+    return part;
+}
+
+size_t edge_cut(graph& g, const unordered_map<int, size_t>& part)
+{
+    size_t cut = 0;
+    for (auto& e: g.get_edges()) {
+        auto& ends = e->get_edge();
+        auto x = part.find(ends.first.get().get_id());
+        auto y = part.find(ends.second.get().get_id());
+        if (x != part.end() && y != part.end() && x->second != y->second) {
+            ++cut;
+        }
+    }
+    return cut;
+}
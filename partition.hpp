@@ -0,0 +1,25 @@
+#ifndef __PARTITION__
+#define __PARTITION__
+
+// C++ includes
+#include "graph.hpp"
+#include <unordered_map>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Split the nodes in parts of about the same size cutting as few edges
+// as possible, returns the part of every node by node id.
+//
+// Label propagation: the nodes start in parts made of consecutive
+// nodes of a breadth first order, which already keeps neighbors
+// together, then every round moves each node to the part most of its
+// neighbors are in, as long as that part is not full (5% over the
+// average size). Rounds stop when nothing moves anymore or after
+// rounds of them.
+std::unordered_map<int, size_t> partition_graph(graph& g, size_t parts, size_t rounds = 10);
+
+// Number of edges between two different parts
+size_t edge_cut(graph& g, const std::unordered_map<int, size_t>& part);
+
+#endif // __PARTITION__
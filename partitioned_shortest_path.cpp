@@ -0,0 +1,509 @@
+#include "partitioned_shortest_path.hpp"
+#include "csr.hpp"
+#include "dijkstra.hpp"
+#include "partition.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// C includes
+#include <cerrno>
+#include <cstdint>      // For int32_t, uint64_t
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+const int partitioned_shortest_path::unreachable = numeric_limits<int>::max();
+
+namespace {
+
+enum class request_type : int32_t
+{
+    quit,
+    // Every (boundary, boundary, distance) of the part
+    boundary,
+    // Every (boundary, distance) from x
+    to_boundary,
+    // Cost then ids of the path from x to y
+    path
+};
+
+struct request
+{
+    request_type type;
+    int32_t x;
+    int32_t y;
+};
+
+// False when the other end is gone
+bool write_all(int fd, const void* data, size_t size)
+{
+    auto p = static_cast<const char*>(data);
+    while (size) {
+        // No SIGPIPE when a worker died, we want the error instead
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t size)
+{
+    auto p = static_cast<char*>(data);
+    while (size) {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Length prefixed array
+template <typename T>
+bool write_vector(int fd, const vector<T>& v)
+{
+    uint64_t count = v.size();
+    return write_all(fd, &count, sizeof(count))
+           && write_all(fd, v.data(), v.size() * sizeof(T));
+}
+
+template <typename T>
+bool read_vector(int fd, vector<T>& v)
+{
+    uint64_t count = 0;
+    if (!read_all(fd, &count, sizeof(count))) {
+        return false;
+    }
+    v.resize(count);
+    return read_all(fd, v.data(), v.size() * sizeof(T));
+}
+
+// Body of a worker process, answers requests on its part until told
+// to quit or the coordinator goes away
+void serve(int fd, const csr& c, const vector<size_t>& boundary)
+{
+    dijkstra search(c);
+    request r;
+    while (read_all(fd, &r, sizeof(r))) {
+        switch (r.type) {
+            case request_type::quit:
+                return;
+            case request_type::boundary:
+            {
+                vector<int32_t> table;
+                for (auto b: boundary) {
+                    search.run(b);
+                    for (auto o: boundary) {
+                        if (o != b && search.get_parent(o) != dijkstra::unreached) {
+                            table.push_back(c.get_id(b));
+                            table.push_back(c.get_id(o));
+                            table.push_back(search.get_distance(o));
+                        }
+                    }
+                }
+                if (!write_vector(fd, table)) {
+                    return;
+                }
+                break;
+            }
+            case request_type::to_boundary:
+            {
+                vector<int32_t> reached;
+                search.run(c.get_index(r.x));
+                for (auto b: boundary) {
+                    if (search.get_parent(b) != dijkstra::unreached) {
+                        reached.push_back(c.get_id(b));
+                        reached.push_back(search.get_distance(b));
+                    }
+                }
+                if (!write_vector(fd, reached)) {
+                    return;
+                }
+                break;
+            }
+            case request_type::path:
+            {
+                size_t ix = c.get_index(r.x);
+                size_t iy = c.get_index(r.y);
+                search.run(ix, iy);
+                int32_t cost = partitioned_shortest_path::unreachable;
+                vector<int32_t> ids;
+                if (search.get_parent(iy) != dijkstra::unreached) {
+                    cost = search.get_distance(iy);
+                    for (size_t i = iy; i != ix; i = search.get_parent(i)) {
+                        ids.push_back(c.get_id(i));
+                    }
+                    ids.push_back(c.get_id(ix));
+                    reverse(ids.begin(), ids.end());
+                }
+                if (!write_all(fd, &cost, sizeof(cost)) || !write_vector(fd, ids)) {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Whole life of a worker process. The part comes over the socket first:
+// the ids of its nodes, then (x, y, cost) for every edge inside it with
+// x and y positions in the ids, then the ids of its boundary nodes. Returns the exit status.
+int run_worker(int fd)
+{
+    try {
+        vector<int32_t> ids;
+        vector<int32_t> edges;
+        vector<int32_t> boundary_ids;
+        if (!read_vector(fd, ids) || !read_vector(fd, edges) || !read_vector(fd, boundary_ids)) {
+            return 1;
+        }
+        graph g;
+        vector<graph::node*> nodes;
+        for (auto id: ids) {
+            nodes.push_back(&g.add_node(id));
+        }
+        for (size_t k = 0; k + 2 < edges.size(); k += 3) {
+            g.add_edge(*nodes[edges[k]], *nodes[edges[k + 1]], edges[k + 2]);
+        }
+        csr local(g);
+        vector<size_t> boundary;
+        for (auto id: boundary_ids) {
+            boundary.push_back(local.get_index(id));
+        }
+        serve(fd, local, boundary);
+    } catch (...) {
+        return 1;
+    }
+    return 0;
+}
+
+}
+
+partitioned_shortest_path::partitioned_shortest_path(graph& g, size_t workers)
+    : _workers(),
+      _part(),
+      _boundary(),
+      _overlay_index(),
+      _overlay()
+{
+    csr whole(g);
+    if (whole.min_cost() < 0) {
+        throw runtime_error("Partitioned shortest paths need non negative costs");
+    }
+    if (!workers) {
+        workers = 1;
+    }
+    try {
+        // Fork before anything else so that the workers start from a
+        // process that has not been touched by the partitioning yet,
+        // they get their part over the socket
+        start_workers(workers);
+        _part = partition_graph(g, workers);
+        vector<size_t> part(whole.node_count());
+        for (size_t i = 0; i < whole.node_count(); ++i) {
+            part[i] = _part[whole.get_id(i)];
+        }
+        // Boundary nodes and the cut edges between them
+        for (size_t i = 0; i < whole.node_count(); ++i) {
+            for (auto a: whole.arcs(i)) {
+                if (part[a.target] != part[i]) {
+                    _overlay_index.insert({whole.get_id(i), _boundary.size()});
+                    _boundary.push_back(whole.get_id(i));
+                    break;
+                }
+            }
+        }
+        _overlay.resize(_boundary.size());
+        for (size_t b = 0; b < _boundary.size(); ++b) {
+            size_t i = whole.get_index(_boundary[b]);
+            for (auto a: whole.arcs(i)) {
+                if (part[a.target] != part[i]) {
+                    _overlay[b].push_back({_overlay_index[whole.get_id(a.target)], a.cost});
+                }
+            }
+        }
+        send_parts(whole, part);
+
+        // Every worker computes its table at the same time
+        for (auto& w: _workers) {
+            request r = {request_type::boundary, 0, 0};
+            if (!write_all(w.socket, &r, sizeof(r))) {
+                throw runtime_error("Worker exited");
+            }
+        }
+        for (auto& w: _workers) {
+            vector<int32_t> table;
+            if (!read_vector(w.socket, table)) {
+                throw runtime_error("Worker exited");
+            }
+            for (size_t k = 0; k + 2 < table.size(); k += 3) {
+                _overlay[_overlay_index[table[k]]].push_back({_overlay_index[table[k + 1]], table[k + 2]});
+            }
+        }
+    } catch (...) {
+        // No destructor for a constructor that throws, the workers
+        // started so far must not outlive us
+        stop_workers();
+        throw;
+    }
+}
+
+void partitioned_shortest_path::start_workers(size_t workers)
+{
+    for (size_t p = 0; p < workers; ++p) {
+        int ends[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) < 0) {
+            throw runtime_error(string("socketpair: ") + strerror(errno));
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(ends[0]);
+            close(ends[1]);
+            throw runtime_error(string("fork: ") + strerror(errno));
+        }
+        if (pid == 0) {
+            // Worker, only keeps its own socket. Nothing of the
+            // coordinator must run here, no destructor and no atexit
+            // handler, hence _exit
+            close(ends[0]);
+            for (auto& w: _workers) {
+                close(w.socket);
+            }
+            int status = run_worker(ends[1]);
+            close(ends[1]);
+            _exit(status);
+        }
+        close(ends[1]);
+        _workers.push_back({pid, ends[0]});
+    }
+}
+
+void partitioned_shortest_path::send_parts(const csr& whole, const vector<size_t>& part)
+{
+    size_t workers = _workers.size();
+    vector<vector<int32_t>> ids(workers);
+    vector<vector<int32_t>> edges(workers);
+    vector<vector<int32_t>> boundary(workers);
+    // Position of every node in the ids of its part
+    vector<size_t> position(whole.node_count());
+    for (size_t i = 0; i < whole.node_count(); ++i) {
+        position[i] = ids[part[i]].size();
+        ids[part[i]].push_back(whole.get_id(i));
+        if (_overlay_index.count(whole.get_id(i))) {
+            boundary[part[i]].push_back(whole.get_id(i));
+        }
+    }
+    for (size_t i = 0; i < whole.node_count(); ++i) {
+        for (auto a: whole.arcs(i)) {
+            // Every edge is two arcs, send it once
+            if (part[a.target] == part[i] && i < a.target) {
+                auto& e = edges[part[i]];
+                e.push_back(static_cast<int32_t>(position[i]));
+                e.push_back(static_cast<int32_t>(position[a.target]));
+                e.push_back(a.cost);
+            }
+        }
+    }
+    for (size_t p = 0; p < workers; ++p) {
+        int fd = _workers[p].socket;
+        if (!write_vector(fd, ids[p]) || !write_vector(fd, edges[p]) || !write_vector(fd, boundary[p])) {
+            throw runtime_error("Worker exited");
+        }
+    }
+}
+
+partitioned_shortest_path::~partitioned_shortest_path()
+{
+    stop_workers();
+}
+
+void partitioned_shortest_path::stop_workers()
+{
+    for (auto& w: _workers) {
+        request r = {request_type::quit, 0, 0};
+        write_all(w.socket, &r, sizeof(r));
+        close(w.socket);
+    }
+    // Closing the socket is enough for a worker still waiting for its
+    // part, it sees the end of the stream and exits
+    for (auto& w: _workers) {
+        waitpid(w.pid, nullptr, 0);
+    }
+    _workers.clear();
+}
+
+size_t partitioned_shortest_path::part_of(int id) const
+{
+    auto iter = _part.find(id);
+    return iter == _part.end() ? _workers.size() : iter->second;
+}
+
+partitioned_shortest_path::distances partitioned_shortest_path::to_boundary(size_t part, int x)
+{
+    int fd = _workers[part].socket;
+    request r = {request_type::to_boundary, x, 0};
+    vector<int32_t> reached;
+    if (!write_all(fd, &r, sizeof(r)) || !read_vector(fd, reached)) {
+        throw runtime_error("Worker exited");
+    }
+    distances d;
+    for (size_t k = 0; k + 1 < reached.size(); k += 2) {
+        d.push_back({reached[k], reached[k + 1]});
+    }
+    return d;
+}
+
+int partitioned_shortest_path::path_in_part(size_t part, int x, int y, vector<int>* ids)
+{
+    int fd = _workers[part].socket;
+    request r = {request_type::path, x, y};
+    int32_t cost = unreachable;
+    vector<int32_t> path;
+    if (!write_all(fd, &r, sizeof(r)) || !read_all(fd, &cost, sizeof(cost))
+        || !read_vector(fd, path)) {
+        throw runtime_error("Worker exited");
+    }
+    if (ids) {
+        ids->assign(path.begin(), path.end());
+    }
+    return cost;
+}
+
+int partitioned_shortest_path::search_overlay(int x, int y, vector<size_t>& hops)
+{
+    static const size_t start = static_cast<size_t>(-1);
+    hops.clear();
+    auto from = to_boundary(part_of(x), x);
+    auto to = to_boundary(part_of(y), y);
+    vector<int> distance(_boundary.size(), unreachable);
+    vector<size_t> parent(_boundary.size(), start);
+    vector<int> last_leg(_boundary.size(), unreachable);
+    for (auto& t: to) {
+        last_leg[_overlay_index[t.first]] = t.second;
+    }
+    typedef pair<int, size_t> entry;
+    auto order = [](const entry& e1, const entry& e2) {return e1.first > e2.first;};
+    vector<entry> open;
+    for (auto& f: from) {
+        size_t b = _overlay_index[f.first];
+        distance[b] = f.second;
+        open.push_back({f.second, b});
+    }
+    make_heap(open.begin(), open.end(), order);
+    int best = unreachable;
+    size_t end = start;
+    while (!open.empty()) {
+        pop_heap(open.begin(), open.end(), order);
+        entry current = open.back();
+        open.pop_back();
+        size_t v = current.second;
+        if (current.first != distance[v]) {
+            continue; // Stale entry
+        }
+        if (current.first >= best) {
+            break; // Nothing left can do better
+        }
+        // Sums that would not fit in an int cannot beat anything
+        if (last_leg[v] != unreachable && current.first < unreachable - last_leg[v]
+            && current.first + last_leg[v] < best) {
+            best = current.first + last_leg[v];
+            end = v;
+        }
+        for (auto& a: _overlay[v]) {
+            if (current.first > unreachable - a.cost) {
+                continue;
+            }
+            int d = current.first + a.cost;
+            if (d < distance[a.target]) {
+                distance[a.target] = d;
+                parent[a.target] = v;
+                open.push_back({d, a.target});
+                push_heap(open.begin(), open.end(), order);
+            }
+        }
+    }
+    for (size_t v = end; v != start; v = parent[v]) {
+        hops.push_back(v);
+    }
+    reverse(hops.begin(), hops.end());
+    return best;
+}
+
+int partitioned_shortest_path::distance(int x, int y)
+{
+    // Only the costs, the workers never send the ids of the legs
+    return route(x, y, nullptr);
+}
+
+bool partitioned_shortest_path::get_path(int x, int y, vector<int>& ids, int& cost)
+{
+    ids.clear();
+    int found = route(x, y, &ids);
+    if (found == unreachable) {
+        return false;
+    }
+    cost = found;
+    return true;
+}
+
+int partitioned_shortest_path::route(int x, int y, vector<int>* ids)
+{
+    size_t px = part_of(x);
+    size_t py = part_of(y);
+    if (px == _workers.size() || py == _workers.size()) {
+        return unreachable;
+    }
+    // Staying in the part may be the best, or the only, way. Ask for
+    // the ids right away, the worker would run the same search again.
+    vector<int> direct_ids;
+    int direct = (px == py) ? path_in_part(px, x, y, ids ? &direct_ids : nullptr) : unreachable;
+    vector<size_t> hops;
+    int over = _boundary.empty() ? unreachable : search_overlay(x, y, hops);
+    if (direct == unreachable && over == unreachable) {
+        return unreachable;
+    }
+    if (direct <= over) {
+        if (ids) {
+            ids->swap(direct_ids);
+        }
+        return direct;
+    }
+    if (!ids) {
+        return over;
+    }
+    // Source to the first boundary node, then every overlay hop, then
+    // the last boundary node to the target
+    vector<int> leg;
+    path_in_part(px, x, _boundary[hops.front()], ids);
+    for (size_t k = 1; k < hops.size(); ++k) {
+        int b = _boundary[hops[k - 1]];
+        int next = _boundary[hops[k]];
+        if (part_of(b) != part_of(next)) {
+            ids->push_back(next); // Cut edge
+            continue;
+        }
+        path_in_part(part_of(b), b, next, &leg);
+        ids->insert(ids->end(), leg.begin() + 1, leg.end());
+    }
+    path_in_part(py, _boundary[hops.back()], y, &leg);
+    ids->insert(ids->end(), leg.begin() + 1, leg.end());
+    return over;
+}
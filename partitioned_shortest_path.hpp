@@ -0,0 +1,92 @@
+#ifndef __PARTITIONED_SHORTEST_PATH__
+#define __PARTITIONED_SHORTEST_PATH__
+
+// C++ includes
+#include "graph.hpp"
+#include <unordered_map>
+#include <utility>      // For pair
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <sys/types.h>  // For pid_t
+
+class csr;
+
+// Shortest paths of a graph split over worker processes.
+//
+// The graph is cut in one part per worker (partition_graph) and every
+// worker process only searches its own part. A node with an edge to
+// another part is a boundary node. At start every worker computes the
+// distances inside its part between all its boundary nodes and hands
+// them to the coordinator (this object) which keeps them, together
+// with the cut edges, as a small overlay graph of boundary nodes. Any
+// path between two parts goes from its source to a boundary node of
+// the source part, then over the overlay, then from a boundary node of
+// the target part to the target. A query asks the two workers for the
+// distances between the ends and their boundary nodes and searches the
+// overlay in between. Paths inside a part come from the worker too.
+//
+// Workers are forked processes talking over a Unix socket pair each,
+// the coordinator only keeps the overlay and the part of every node.
+// The workers are forked first thing and get their part over the
+// socket, they never look at the memory they inherit. They still
+// allocate, so build the object before starting any thread: a lock
+// held by another thread at the fork stays locked forever in the
+// child. The object is not thread safe, queries go to the workers one
+// at a time. Costs must be non negative, runtime_error otherwise, and
+// runtime_error is also what a worker going away turns into. Workers
+// already started are stopped and reaped when the constructor throws.
+class partitioned_shortest_path
+{
+    public:
+        static const int unreachable;
+
+        partitioned_shortest_path(graph& g, size_t workers);
+        ~partitioned_shortest_path();
+        partitioned_shortest_path(const partitioned_shortest_path&) = delete;
+        partitioned_shortest_path& operator=(const partitioned_shortest_path&) = delete;
+
+        size_t worker_count() const {return _workers.size();}
+        size_t boundary_count() const {return _boundary.size();}
+        int distance(int x, int y);
+        // Cheapest path from x to y as a list of ids starting with x.
+        // Returns false when y cannot be reached from x.
+        bool get_path(int x, int y, std::vector<int>& ids, int& cost);
+    private:
+        struct worker
+        {
+            pid_t pid;
+            int socket;
+        };
+        // (node id, distance)
+        typedef std::vector<std::pair<int, int>> distances;
+        struct overlay_arc
+        {
+            size_t target;
+            int cost;
+        };
+        void start_workers(size_t workers);
+        // Every worker gets the nodes and edges of its part and its
+        // boundary nodes
+        void send_parts(const csr& whole, const std::vector<size_t>& part);
+        // Tells the workers to quit and waits for them
+        void stop_workers();
+        // Best way from x to y over the overlay, as the boundary nodes
+        // (overlay indices) it goes through
+        int search_overlay(int x, int y, std::vector<size_t>& hops);
+        // Cost from x to y, unreachable when there is no path. The ids
+        // of the path are only asked for when ids is not nullptr.
+        int route(int x, int y, std::vector<int>* ids);
+        distances to_boundary(size_t part, int x);
+        int path_in_part(size_t part, int x, int y, std::vector<int>* ids);
+        size_t part_of(int id) const;
+        std::vector<worker> _workers;
+        std::unordered_map<int, size_t> _part; // By node id
+        // Overlay nodes are the boundary nodes
+        std::vector<int> _boundary;
+        std::unordered_map<int, size_t> _overlay_index; // By node id
+        std::vector<std::vector<overlay_arc>> _overlay;
+};
+
+#endif // __PARTITIONED_SHORTEST_PATH__
@@ -2,41 +2,48 @@
 
 using namespace std;
 
-void path::set_predecessor(path& p)
+template <typename Cost, typename Id>
+void basic_path<Cost, Id>::set_predecessor(basic_path& p)
 {
     _predecessor = &p;
 }
 
-path* path::get_predecessor()
+template <typename Cost, typename Id>
+basic_path<Cost, Id>* basic_path<Cost, Id>::get_predecessor()
 {
     return _predecessor;
 }
 
-graph::node& path::get_node()
+template <typename Cost, typename Id>
+typename basic_path<Cost, Id>::graph_type::node& basic_path<Cost, Id>::get_node()
 {
     return _node;
 }
 
-void path::set_cost(int cost)
+template <typename Cost, typename Id>
+void basic_path<Cost, Id>::set_cost(Cost cost)
 {
     _cost = cost;
 }
 
-int path::get_cost()
+template <typename Cost, typename Id>
+Cost basic_path<Cost, Id>::get_cost()
 {
     return _cost;
 }
 
-ostream& operator<<(ostream& out, path& p)
+template <typename Cost, typename Id>
+ostream& operator<<(ostream& out, basic_path<Cost, Id>& p)
 {
-    path* predecessor = p.get_predecessor();
+    basic_path<Cost, Id>* predecessor = p.get_predecessor();
     if (predecessor) (out << predecessor->get_node()); else out << "nullptr";
     return out << "<--" << p.get_node();
 }
 
-void path::print_full_path(ostream& out, path& start)
+template <typename Cost, typename Id>
+void basic_path<Cost, Id>::print_full_path(ostream& out, basic_path& start)
 {
-    path* current = &start;
+    basic_path* current = &start;
     while (current) {
         out << current->get_node();
         current = current->get_predecessor();
@@ -46,3 +53,14 @@ void path::print_full_path(ostream& out, path& start)
     }
     out << endl;
 }
+
+template class basic_path<int, int>;
+template class basic_path<int, uint32_t>;
+template class basic_path<float, int>;
+template class basic_path<double, int>;
+template class basic_path<double, uint32_t>;
+template ostream& operator<<(ostream& out, basic_path<int, int>& p);
+template ostream& operator<<(ostream& out, basic_path<int, uint32_t>& p);
+template ostream& operator<<(ostream& out, basic_path<float, int>& p);
+template ostream& operator<<(ostream& out, basic_path<double, int>& p);
+template ostream& operator<<(ostream& out, basic_path<double, uint32_t>& p);
@@ -5,13 +5,18 @@
 #include <iostream>
 #include <stdexcept>
 
-// We need a type for the shortest path segment
-class path;
-std::ostream& operator<<(std::ostream& out, path& p);
-class path
+// We need a type for the shortest path segment, generic like the
+// graph it walks through
+template <typename Cost, typename Id>
+class basic_path;
+template <typename Cost, typename Id>
+std::ostream& operator<<(std::ostream& out, basic_path<Cost, Id>& p);
+template <typename Cost, typename Id>
+class basic_path
 {
     public:
-        path(graph::node& n, path* p = nullptr, int cost = 0)
+        typedef basic_graph<Cost, Id> graph_type;
+        basic_path(typename graph_type::node& n, basic_path* p = nullptr, Cost cost = Cost())
             : _node(n),
               _predecessor(p)
         {
@@ -20,12 +25,12 @@ class path
                 _cost += p->get_cost();
             }
         }
-        path(graph::node& n, path& p, int cost = 0)
+        basic_path(typename graph_type::node& n, basic_path& p, Cost cost = Cost())
             : _node(n),
               _predecessor(&p),
               _cost(cost + p.get_cost())
         {}
-        path(graph::edge& e, path& p)
+        basic_path(typename graph_type::edge& e, basic_path& p)
             : _node(e.get_edge().second),
               _predecessor(&p),
               _cost(e.get_cost() + p.get_cost())
@@ -34,17 +39,25 @@ class path
                 throw std::runtime_error("Edge and path predecessor mismatch");
             }
         }
-        path() = delete;
-        void set_predecessor(path& p);
-        path* get_predecessor();
-        graph::node& get_node();
-        void set_cost(int cost);
-        int get_cost();
-        static void print_full_path(std::ostream& out, path& start);
+        basic_path() = delete;
+        void set_predecessor(basic_path& p);
+        basic_path* get_predecessor();
+        typename graph_type::node& get_node();
+        void set_cost(Cost cost);
+        Cost get_cost();
+        static void print_full_path(std::ostream& out, basic_path& start);
     private:
-        graph::node_ref _node;
-        path* _predecessor;
-        int _cost;
+        typename graph_type::node_ref _node;
+        basic_path* _predecessor;
+        Cost _cost;
 };
 
+// Same combinations as basic_graph, compiled in path.cpp
+extern template class basic_path<int, int>;
+extern template class basic_path<int, uint32_t>;
+extern template class basic_path<float, int>;
+extern template class basic_path<double, int>;
+extern template class basic_path<double, uint32_t>;
+typedef basic_path<int, int> path;
+
 #endif // __PATH__
@@ -1,90 +1,680 @@
 #include "shortest_path.hpp"
+#include "bfs.hpp"
+#include "csr.hpp"
+#include "delta_stepping.hpp"
+#include "trace.hpp"
 
-#include <functional> // For hash
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 using namespace std;
 
-ostream& operator<<(ostream& out, shortest_path& s)
+// Below this many edges a single core Dijkstra beats the
+// synchronization of the delta-stepping phases
+static const size_t delta_stepping_edges = 1 << 20;
+
+namespace {
+
+// Monotone priority queue for integer keys (radix heap). Bucket 0
+// holds the keys equal to the last one popped, bucket b the keys whose
+// highest bit differing from it is bit b - 1. Popping from an empty
+// bucket 0 takes the smallest key of the first non empty bucket as
+// the new last and spreads that bucket over the lower ones.
+template <typename Key>
+class radix_heap
+{
+    public:
+        typedef std::pair<Key, size_t> entry;
+        radix_heap() : _buckets(sizeof(Key) * 8 + 1), _last(0), _size(0) {}
+        bool empty() const {return _size == 0;}
+        size_t size() const {return _size;}
+        // key must not be below the last key popped
+        void push(Key key, size_t value)
+        {
+            _buckets[bucket(key)].push_back({key, value});
+            ++_size;
+        }
+        entry pop()
+        {
+            if (_buckets[0].empty()) {
+                size_t b = 1;
+                while (_buckets[b].empty()) {
+                    ++b;
+                }
+                _last = _buckets[b].front().first;
+                for (auto& e: _buckets[b]) {
+                    _last = std::min(_last, e.first);
+                }
+                for (auto& e: _buckets[b]) {
+                    _buckets[bucket(e.first)].push_back(e);
+                }
+                _buckets[b].clear();
+            }
+            entry e = _buckets[0].back();
+            _buckets[0].pop_back();
+            --_size;
+            return e;
+        }
+    private:
+        size_t bucket(Key key) const
+        {
+            typedef typename std::make_unsigned<Key>::type bits;
+            bits diff = static_cast<bits>(key) ^ static_cast<bits>(_last);
+            size_t b = 0;
+            while (diff) {
+                diff >>= 1;
+                ++b;
+            }
+            return b;
+        }
+        std::vector<std::vector<entry>> _buckets;
+        Key _last;
+        size_t _size;
+};
+
+// Binary min heap with the interface of radix_heap, for the floating
+// point costs a radix heap cannot take
+template <typename Key>
+class binary_heap
+{
+    public:
+        typedef std::pair<Key, size_t> entry;
+        bool empty() const {return _entries.empty();}
+        size_t size() const {return _entries.size();}
+        void push(Key key, size_t value)
+        {
+            _entries.push_back({key, value});
+            std::push_heap(_entries.begin(), _entries.end(), order);
+        }
+        entry pop()
+        {
+            std::pop_heap(_entries.begin(), _entries.end(), order);
+            entry e = _entries.back();
+            _entries.pop_back();
+            return e;
+        }
+    private:
+        static bool order(const entry& e1, const entry& e2) {return e1.first > e2.first;}
+        std::vector<entry> _entries;
+};
+
+// Dijkstra over anything with the arc interface of csr (node_count,
+// arc_begin, arc_end, target, cost). The queue is picked when
+// compiling: a radix heap for integer costs, a binary heap otherwise,
+// the loop itself never looks at the cost type.
+template <typename Adjacency, typename Cost>
+class cost_search
 {
-    for (auto& src: s._paths) {
-        out << "Path from " << src.first.get() << endl;
-        for (auto& dest: *(src.second)) {
-            if (src.first.get() == dest.first.get()) {
+    public:
+        static const size_t unreached = static_cast<size_t>(-1);
+        typedef typename conditional<is_integral<Cost>::value,
+                                     radix_heap<Cost>, binary_heap<Cost>>::type queue;
+        explicit cost_search(const Adjacency& c)
+            : _c(c),
+              _distance(c.node_count(), Cost()),
+              _parent(c.node_count(), unreached),
+              _order(),
+              _closed(c.node_count(), false)
+        {
+            STATS_ADD(bytes_allocated, c.node_count() * (sizeof(Cost) + sizeof(size_t)));
+        }
+        void run(size_t source);
+        const vector<size_t>& get_order() const {return _order;}
+        size_t get_parent(size_t i) const {return _parent[i];}
+        Cost hop_cost(size_t parent, size_t i) const {return _distance[i] - _distance[parent];}
+    private:
+        const Adjacency& _c;
+        vector<Cost> _distance;
+        vector<size_t> _parent;
+        vector<size_t> _order;
+        vector<bool> _closed;
+};
+
+template <typename Adjacency, typename Cost>
+const size_t cost_search<Adjacency, Cost>::unreached;
+
+template <typename Adjacency, typename Cost>
+void cost_search<Adjacency, Cost>::run(size_t source)
+{
+    for (auto i: _order) {
+        _parent[i] = unreached;
+        _closed[i] = false;
+    }
+    _order.clear();
+    queue open;
+    _parent[source] = source;
+    _distance[source] = Cost();
+    open.push(Cost(), source);
+    STATS_ADD(heap_pushes, 1);
+    while (!open.empty()) {
+        auto current = open.pop();
+        STATS_ADD(heap_pops, 1);
+        size_t v = current.second;
+        if (_closed[v] || current.first != _distance[v]) {
+            continue; // Stale entry
+        }
+        _closed[v] = true;
+        _order.push_back(v);
+        STATS_ADD(nodes_settled, 1);
+        STATS_ADD(edges_relaxed, _c.arc_end(v) - _c.arc_begin(v));
+        for (size_t a = _c.arc_begin(v); a < _c.arc_end(v); ++a) {
+            size_t t = _c.target(a);
+            Cost d = current.first + _c.cost(a);
+            if (_closed[t]) {
                 continue;
             }
-            out << "Path to " << dest.first.get() << endl;
-            path::print_full_path(out, *(dest.second));
+            if (_parent[t] == unreached || d < _distance[t]) {
+                if (_parent[t] != unreached) {
+                    STATS_ADD(decrease_keys, 1);
+                }
+                _parent[t] = v;
+                _distance[t] = d;
+                open.push(d, t);
+                STATS_ADD(heap_pushes, 1);
+            }
         }
+        STATS_MAX(peak_open_set, open.size());
     }
-    return out;
 }
 
-size_t shortest_path::node_ref_hash::operator()(const graph::node_ref& n) const
+// The two parallel engines with the interface of cost_search
+class bfs_search
+{
+    public:
+        bfs_search(const csr& c, size_t threads)
+            // Every edge has this cost with bfs so the cheapest path
+            // is the one with the fewest hops
+            : _engine(c, threads), _uniform_cost(c.min_cost()) {}
+        void run(size_t source) {_engine.run(source);}
+        const vector<size_t>& get_order() const {return _engine.get_order();}
+        size_t get_parent(size_t i) const {return _engine.get_parent(i);}
+        int hop_cost(size_t, size_t) const {return _uniform_cost;}
+    private:
+        bfs _engine;
+        int _uniform_cost;
+};
+
+class delta_stepping_search
 {
-    return hash<int>()(n.get().get_id());
+    public:
+        delta_stepping_search(const csr& c, size_t threads) : _engine(c, threads) {}
+        void run(size_t source) {_engine.run(source);}
+        const vector<size_t>& get_order() const {return _engine.get_order();}
+        size_t get_parent(size_t i) const {return _engine.get_parent(i);}
+        int hop_cost(size_t parent, size_t i) const
+        {
+            return _engine.get_distance(i) - _engine.get_distance(parent);
+        }
+    private:
+        delta_stepping _engine;
+};
+
 }
-void shortest_path::compute_paths()
+
+// Any cost and id type: flat adjacency like csr with the costs in
+// their own type, searched by Dijkstra
+template <typename Cost, typename Id>
+class shortest_path_part
 {
-    // Compute shortest path with each node in graph as source
-    for(auto& node: _g.get_nodes()) {
-        auto closed = unique_ptr<node_paths>(new node_paths());
-        open_set open;
-        auto tmp = path_ptr(new path(*node));
-        open.push_back(tmp); // no need to make_heap as it is a single element
-        while (!open.empty()) {
-            pop_heap(open.begin(), open.end(), open_set_order());
-            path_ptr current = open.back(); // Next smallest path
-            open.pop_back();
-            closed->insert({current->get_node(), current}); // shortest for curremt
-            auto neighbors = current->get_node().get_neighbors();
-            for (auto neighbor: neighbors) {
-                auto closed_iter = closed->find(neighbor);
-                if (closed_iter != closed->end()) {
-                    continue;
+    public:
+        typedef basic_graph<Cost, Id> graph_type;
+        typedef typename graph_type::node node;
+        struct edge_record
+        {
+            size_t x;
+            size_t y;
+            Cost cost;
+        };
+        shortest_path_part(vector<node*> nodes, const vector<edge_record>& edges);
+        static bool supports(shortest_path_backend b) {return b == shortest_path_backend::dijkstra;}
+        size_t node_count() const {return _nodes.size();}
+        node& get_node(size_t i) const {return *_nodes[i];}
+        size_t arc_begin(size_t i) const {return _offsets[i];}
+        size_t arc_end(size_t i) const {return _offsets[i + 1];}
+        size_t target(size_t a) const {return _targets[a];}
+        Cost cost(size_t a) const {return _costs[a];}
+        // Builds the search of the backend and hands it to visit, so
+        // that visit is compiled for the exact search type and nothing
+        // per node goes through a switch on the backend
+        template <typename Visitor>
+        void search(shortest_path_backend, bool, Visitor& visit) const
+        {
+            cost_search<shortest_path_part, Cost> s(*this);
+            visit(s);
+        }
+    private:
+        vector<node*> _nodes;
+        vector<size_t> _offsets;
+        vector<uint32_t> _targets;
+        vector<Cost> _costs;
+};
+
+template <typename Cost, typename Id>
+shortest_path_part<Cost, Id>::shortest_path_part(vector<node*> nodes, const vector<edge_record>& edges)
+    : _nodes(move(nodes)), _offsets(_nodes.size() + 1, 0), _targets(), _costs()
+{
+    for (auto& e: edges) {
+        ++_offsets[e.x + 1];
+        ++_offsets[e.y + 1];
+    }
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        _offsets[i + 1] += _offsets[i];
+    }
+    _targets.resize(_offsets.back());
+    _costs.resize(_offsets.back());
+    vector<size_t> fill(_offsets.begin(), _offsets.end() - 1);
+    for (auto& e: edges) {
+        _targets[fill[e.x]] = static_cast<uint32_t>(e.y);
+        _costs[fill[e.x]++] = e.cost;
+        _targets[fill[e.y]] = static_cast<uint32_t>(e.x);
+        _costs[fill[e.y]++] = e.cost;
+    }
+}
+
+// int costs and ids: a csr of the component, the radix heap kernel for
+// dijkstra and the parallel engines for the other backends
+template <>
+class shortest_path_part<int, int>
+{
+    public:
+        explicit shortest_path_part(unique_ptr<csr> c) : _csr(move(c)) {}
+        static bool supports(shortest_path_backend) {return true;}
+        size_t node_count() const {return _csr->node_count();}
+        graph::node& get_node(size_t i) const {return _csr->get_node(i);}
+        // The backend is looked at once per call, not once per node.
+        // On the executor every search runs on a single thread, the
+        // executor already keeps the others busy.
+        template <typename Visitor>
+        void search(shortest_path_backend b, bool on_executor, Visitor& visit) const
+        {
+            size_t threads = on_executor ? 1 : 0;
+            switch (b) {
+                case shortest_path_backend::bfs:
+                {
+                    bfs_search s(*_csr, threads);
+                    visit(s);
+                    break;
                 }
-                auto open_iter = find_if(open.begin(),
-                                    open.end(),
-                                    [&](const path_ptr& i)
-                                    {
-                                        return i->get_node() == neighbor.get();
-                                    }
-                                    );
-                auto edge_iter = _g.get_edge_iterator(neighbor, current->get_node());
-                auto new_path = path_ptr(new path(neighbor, current.get(), (*edge_iter)->get_cost()));
-                if (open_iter == open.end()) {
-                    // We have never seen this node add a new path
-                    open.push_back(new_path);
-                    make_heap(open.begin(), open.end(), open_set_order());
-                    continue;
+                case shortest_path_backend::delta_stepping:
+                {
+                    delta_stepping_search s(*_csr, threads);
+                    visit(s);
+                    break;
                 }
-                // We have already a path check if we improve it
-                if ((*open_iter)->get_cost() > new_path->get_cost()) {
-                    swap(*open_iter, new_path);
-                    make_heap(open.begin(), open.end(), open_set_order());
+                default:
+                {
+                    cost_search<csr, int> s(*_csr);
+                    visit(s);
+                    break;
                 }
             }
         }
-        _paths[*node] = move(closed); // We have computed all the paths for the given source
+    private:
+        unique_ptr<csr> _csr;
+};
+
+namespace {
+
+// One part per component, nullptr for the isolated nodes
+template <typename Cost, typename Id>
+vector<unique_ptr<shortest_path_part<Cost, Id>>>
+make_parts(basic_graph<Cost, Id>& g, const vector<vector<typename basic_graph<Cost, Id>::node*>>& members)
+{
+    typedef shortest_path_part<Cost, Id> part_type;
+    unordered_map<typename basic_graph<Cost, Id>::node*, pair<size_t, size_t>> where;
+    for (size_t p = 0; p < members.size(); ++p) {
+        for (size_t i = 0; i < members[p].size(); ++i) {
+            where.insert({members[p][i], {p, i}});
+        }
+    }
+    vector<vector<typename part_type::edge_record>> edges(members.size());
+    for (auto& e: g.get_edges()) {
+        auto& x = where[&e->get_edge().first.get()];
+        auto& y = where[&e->get_edge().second.get()];
+        edges[x.first].push_back({x.second, y.second, e->get_cost()});
+    }
+    vector<unique_ptr<part_type>> parts(members.size());
+    for (size_t p = 0; p < members.size(); ++p) {
+        if (members[p].size() > 1) {
+            parts[p].reset(new part_type(members[p], edges[p]));
+        }
     }
-    _ran = true;
+    return parts;
 }
 
-path* shortest_path::get_path(graph::node& n1, graph::node& n2)
+// The csr of the whole graph once, then one for each component
+vector<unique_ptr<shortest_path_part<int, int>>>
+make_parts(graph& g, const vector<vector<graph::node*>>& members)
 {
-    if(!_ran) {
-        compute_paths();
+    csr whole(g);
+    vector<unique_ptr<shortest_path_part<int, int>>> parts(members.size());
+    vector<size_t> indices;
+    for (size_t p = 0; p < members.size(); ++p) {
+        if (members[p].size() < 2) {
+            continue;
+        }
+        indices.clear();
+        for (auto n: members[p]) {
+            indices.push_back(whole.get_index(*n));
+        }
+        parts[p].reset(new shortest_path_part<int, int>(unique_ptr<csr>(new csr(whole, indices))));
     }
-    auto iter = _paths.find(ref(n1));
-    if (iter == _paths.end()) {
-        // Here we should rather assert as normally there should be
-        // one entry per node even if the graph is totally disconnected
-        return nullptr;
+    return parts;
+}
+
+}
+
+template <typename Cost, typename Id>
+basic_shortest_path<Cost, Id>::basic_shortest_path(graph_type& g,
+                                                   backend b,
+                                                   bool precompute,
+                                                   size_t max_in_flight)
+    : _g(g), _backend(b), _stats(), _precompute(precompute), _max_in_flight(max_in_flight),
+      _lock(), _parts(), _tables(), _locations(), _waiting(), _executor()
+{
+    compute_paths();
+}
+
+template <typename Cost, typename Id>
+basic_shortest_path<Cost, Id>::~basic_shortest_path()
+{
+}
+
+template <typename Cost, typename Id>
+void basic_shortest_path<Cost, Id>::compute_paths()
+{
+    TRACE_SPAN("compute_paths");
+#ifdef SHORTEST_PATH_STATS
+    auto start = chrono::steady_clock::now();
+    _stats = stats();
+    thread_counters() = search_counters();
+#endif
+    for (auto& e: _g.get_edges()) {
+        if (e->get_cost() < Cost()) {
+            // Edges go both ways, a negative one is a negative cycle and
+            // no path through it has a cheapest cost
+            throw runtime_error("Negative cost edge");
+        }
+    }
+    if (_backend == backend::automatic) {
+        _backend = select_backend();
     }
-    auto& node_paths = iter->second;
-    auto iter2 = node_paths->find(ref(n2));
-    if (iter2 == node_paths->end()) {
+    if (!part_type::supports(_backend)) {
+        throw runtime_error("Backend only available with int costs and ids");
+    }
+    unordered_map<node*, size_t> component;
+    vector<vector<node*>> members;
+    for (auto& n: _g.get_nodes()) {
+        auto& leader = _g.find_component(*n);
+        auto iter = component.insert({&leader, members.size()});
+        if (iter.second) {
+            members.push_back(vector<node*>());
+        }
+        members[iter.first->second].push_back(n.get());
+    }
+    auto parts = make_parts(_g, members);
+    _tables.resize(parts.size());
+    for (size_t p = 0; p < parts.size(); ++p) {
+        if (!parts[p]) {
+            // Isolated node, the only path is the empty one
+            auto& n = *members[p].front();
+            _locations.insert({&n, {p, 0}});
+            auto paths = unique_ptr<table>(new table());
+            paths->push_back(path_ptr(new path_type(n)));
+            STATS_ADD(bytes_allocated, sizeof(path_type));
+            _tables[p].push_back(move(paths));
+            continue;
+        }
+        auto& part = *parts[p];
+        for (size_t i = 0; i < part.node_count(); ++i) {
+            _locations.insert({&part.get_node(i), {p, i}});
+        }
+        _tables[p].resize(part.node_count());
+        if (_precompute) {
+            // Compute shortest path with each node in the component as source
+            fill_tables fill(*this, part, 0, part.node_count(), _tables[p]);
+            part.search(_backend, false, fill);
+        }
+    }
+    if (!_precompute) {
+        // Keep the snapshots around for the searches to come
+        _parts = move(parts);
+    }
+#ifdef SHORTEST_PATH_STATS
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    _stats.total_seconds = elapsed.count();
+    _stats += thread_counters();
+#endif
+}
+
+// Tables of the sources in [begin, end) into out[source - begin], with
+// the search the part picked for the backend
+template <typename Cost, typename Id>
+struct basic_shortest_path<Cost, Id>::fill_tables
+{
+    basic_shortest_path& self;
+    const part_type& part;
+    size_t begin;
+    size_t end;
+    vector<unique_ptr<table>>& out;
+    fill_tables(basic_shortest_path& s, const part_type& p, size_t b, size_t e,
+                vector<unique_ptr<table>>& o)
+        : self(s), part(p), begin(b), end(e), out(o) {}
+    template <typename Search>
+    void operator()(Search& search)
+    {
+        for (size_t source = begin; source < end; ++source) {
+            out[source - begin] = self.search_from(part, source, search);
+        }
+    }
+};
+
+template <typename Cost, typename Id>
+typename basic_shortest_path<Cost, Id>::backend basic_shortest_path<Cost, Id>::select_backend()
+{
+    auto& edges = _g.get_edges();
+    bool uniform = true;
+    for (auto& e: edges) {
+        if (e->get_cost() != edges.front()->get_cost()) {
+            uniform = false;
+            break;
+        }
+    }
+    if (uniform && part_type::supports(backend::bfs)) {
+        return backend::bfs;
+    }
+    if (_g.edge_count() >= delta_stepping_edges && part_type::supports(backend::delta_stepping)) {
+        return backend::delta_stepping;
+    }
+    return backend::dijkstra;
+}
+
+template <typename Cost, typename Id>
+template <typename Search>
+unique_ptr<typename basic_shortest_path<Cost, Id>::table>
+basic_shortest_path<Cost, Id>::search_from(const part_type& part, size_t source, Search& search)
+{
+    // One span per source, with the id of the source
+    TRACE_SPAN_VALUE("search", part.get_node(source).get_id());
+#ifdef SHORTEST_PATH_STATS
+    auto start = chrono::steady_clock::now();
+#endif
+    search.run(source);
+    // The searches report the nodes in an order where the parent
+    // always comes before its children so the predecessor path
+    // is ready by the time we need it
+    auto paths = unique_ptr<table>(new table(part.node_count()));
+    for (auto i: search.get_order()) {
+        auto& n = part.get_node(i);
+        if (i == source) {
+            (*paths)[i] = path_ptr(new path_type(n));
+        } else {
+            size_t parent = search.get_parent(i);
+            (*paths)[i] = path_ptr(new path_type(n, (*paths)[parent].get(),
+                                                 search.hop_cost(parent, i)));
+        }
+        STATS_ADD(bytes_allocated, sizeof(path_type));
+    }
+#ifdef SHORTEST_PATH_STATS
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    record_source(part.get_node(source), elapsed.count());
+#endif
+    return paths;
+}
+
+template <typename Cost, typename Id>
+typename basic_shortest_path<Cost, Id>::stats basic_shortest_path<Cost, Id>::get_stats()
+{
+    lock_guard<mutex> lock(_lock);
+    return _stats;
+}
+
+template <typename Cost, typename Id>
+void basic_shortest_path<Cost, Id>::record_source(node& source, double seconds)
+{
+    lock_guard<mutex> lock(_lock);
+    _stats.source_seconds.push_back({source, seconds});
+#ifdef SHORTEST_PATH_STATS
+    // Searches on the executor count on their own thread
+    if (!_precompute) {
+        _stats += thread_counters();
+        thread_counters() = search_counters();
+    }
+#endif
+}
+
+template <typename Cost, typename Id>
+void basic_shortest_path<Cost, Id>::search_location(location l)
+{
+    auto& part = *_parts[l.part];
+    auto& source = part.get_node(l.index);
+    unique_ptr<table> paths;
+    try {
+        // One search at a time per worker thread so the search and
+        // its buffers are private to this call
+        vector<unique_ptr<table>> searched(1);
+        fill_tables fill(*this, part, l.index, l.index + 1, searched);
+        part.search(_backend, true, fill);
+        paths = move(searched.front());
+    } catch (...) {
+        // Hand the failure to everybody waiting, the next request
+        // for this source will try again
+        vector<waiter> waiting;
+        {
+            lock_guard<mutex> lock(_lock);
+            waiting.swap(_waiting[&source]);
+            _waiting.erase(&source);
+        }
+        for (auto& w: waiting) {
+            w.result.set_exception(current_exception());
+        }
+        return;
+    }
+
+    vector<waiter> waiting;
+    table* published = paths.get();
+    {
+        lock_guard<mutex> lock(_lock);
+        _tables[l.part][l.index] = move(paths);
+        waiting.swap(_waiting[&source]);
+        _waiting.erase(&source);
+    }
+    // The table of a source never changes once published so
+    // it can be read without the lock
+    for (auto& w: waiting) {
+        w.result.set_value((*published)[w.target].get());
+    }
+}
+
+template <typename Cost, typename Id>
+typename basic_shortest_path<Cost, Id>::path_type*
+basic_shortest_path<Cost, Id>::get_path(typename graph_type::node& n1,
+                                        typename graph_type::node& n2)
+{
+    TRACE_SPAN("get_path");
+    if (!_precompute) {
+        return async_get_path(n1, n2).get();
+    }
+    auto l1 = _locations.find(&n1);
+    auto l2 = _locations.find(&n2);
+    if (l1 == _locations.end() || l2 == _locations.end() || l1->second.part != l2->second.part) {
+        // Different components, no need to look at the tables
         return nullptr;
     }
-    return iter2->second.get();
+    return (*_tables[l1->second.part][l1->second.index])[l2->second.index].get();
+}
+
+template <typename Cost, typename Id>
+future<typename basic_shortest_path<Cost, Id>::path_type*>
+basic_shortest_path<Cost, Id>::async_get_path(typename graph_type::node& n1,
+                                              typename graph_type::node& n2)
+{
+    promise<path_type*> result;
+    auto f = result.get_future();
+    if (_precompute) {
+        result.set_value(get_path(n1, n2));
+        return f;
+    }
+    auto l1 = _locations.find(&n1);
+    auto l2 = _locations.find(&n2);
+    if (l1 == _locations.end() || l2 == _locations.end() || l1->second.part != l2->second.part) {
+        result.set_value(nullptr);
+        return f;
+    }
+    lock_guard<mutex> lock(_lock);
+    auto& paths = _tables[l1->second.part][l1->second.index];
+    if (paths) {
+        result.set_value((*paths)[l2->second.index].get());
+        return f;
+    }
+    auto& waiting = _waiting[&n1];
+    waiting.push_back({move(result), l2->second.index});
+    if (waiting.size() == 1) {
+        // First request for this source, nobody searches it yet
+        if (!_executor) {
+            _executor.reset(new executor(_max_in_flight));
+        }
+        location l = l1->second;
+        _executor->submit([this, l]() {search_location(l);});
+    }
+    return f;
+}
+
+template <typename Cost, typename Id>
+ostream& operator<<(ostream& out, basic_shortest_path<Cost, Id>& s)
+{
+    for (auto& part: s._tables) {
+        for (size_t source = 0; source < part.size(); ++source) {
+            if (!part[source]) {
+                continue;
+            }
+            auto& paths = *part[source];
+            out << "Path from " << paths[source]->get_node() << endl;
+            for (size_t target = 0; target < paths.size(); ++target) {
+                if (target == source || !paths[target]) {
+                    continue;
+                }
+                out << "Path to " << paths[target]->get_node() << endl;
+                basic_path<Cost, Id>::print_full_path(out, *paths[target]);
+            }
+        }
+    }
+    return out;
 }
+
+template class basic_shortest_path<int, int>;
+template class basic_shortest_path<int, uint32_t>;
+template class basic_shortest_path<float, int>;
+template class basic_shortest_path<double, int>;
+template class basic_shortest_path<double, uint32_t>;
+template ostream& operator<<(ostream& out, basic_shortest_path<int, int>& s);
+template ostream& operator<<(ostream& out, basic_shortest_path<int, uint32_t>& s);
+template ostream& operator<<(ostream& out, basic_shortest_path<float, int>& s);
+template ostream& operator<<(ostream& out, basic_shortest_path<double, int>& s);
+template ostream& operator<<(ostream& out, basic_shortest_path<double, uint32_t>& s);
@@ -1,67 +1,148 @@
 #ifndef __SHORTEST_PATH__
 #define __SHORTEST_PATH__
 
+#include "executor.hpp"
 #include "graph.hpp"
 #include "path.hpp"
+#include "stats.hpp"
 
+#include <future>
 #include <iostream>
-#include <memory> // For unique_ptr, shared_ptr
+#include <memory> // For unique_ptr
+#include <mutex>
 #include <unordered_map>
+#include <utility> // For pair
 #include <vector>
 
-class shortest_path
+// Search algorithm used to fill the tables. automatic picks the
+// breadth first search when all the edges have the same cost, the
+// parallel delta-stepping for other costs on graphs large enough to
+// keep several cores busy and Dijkstra otherwise. Only int costs and
+// ids have the three of them, any other type only has dijkstra, which
+// is what automatic then always picks.
+enum class shortest_path_backend
+{
+    automatic,
+    dijkstra,
+    bfs,
+    delta_stepping
+};
+
+// Snapshot of one connected component and the searches that run on it,
+// the only piece that depends on the cost and id types. Defined in
+// shortest_path.cpp: int costs and ids use csr, any other type its own
+// flat adjacency. Dijkstra uses a radix heap for integer costs and a
+// binary heap otherwise, picked when compiling; int costs and ids also
+// have the bfs and delta_stepping engines.
+template <typename Cost, typename Id>
+class shortest_path_part;
+
+template <typename Cost, typename Id>
+class basic_shortest_path;
+template <typename Cost, typename Id>
+std::ostream& operator<<(std::ostream& out, basic_shortest_path<Cost, Id>& s);
+
+// Every pair shortest paths of a basic_graph with any cost and id type.
+//
+// Searches never leave the component of their source so every
+// component gets its own small snapshot and the searches only ever
+// size their buffers for one component. Costs must be non negative:
+// edges go both ways so a negative one is a negative cycle, and the
+// constructor throws runtime_error on it. The components are recorded
+// by the constructor, queries never look at the graph again and nodes
+// added afterwards have no path.
+template <typename Cost, typename Id>
+class basic_shortest_path
 {
     public:
-        shortest_path(graph& g) : _g(g), _ran(false), _paths(){compute_paths();}
-        path* get_path(graph::node& n1, graph::node& n2);
-        friend std::ostream& operator<<(std::ostream& out, shortest_path& s);
-    private:
-        // I tried using unique_ptr here but priority_queue
-        // does not provide access to non const version
-        // of the contained object so it is impossible to
-        // move it
-        typedef std::shared_ptr<path> path_ptr;
-        struct node_ref_hash
+        typedef basic_graph<Cost, Id> graph_type;
+        typedef basic_path<Cost, Id> path_type;
+        typedef shortest_path_backend backend;
+        // What the last compute_paths did. Only filled when built
+        // with -DSHORTEST_PATH_STATS, all zeros otherwise.
+        struct stats : public search_counters
         {
-            size_t operator()(const graph::node_ref& n) const;
+            // Wall time of every single source search in seconds
+            std::vector<std::pair<typename graph_type::node_ref, double>> source_seconds;
+            double total_seconds;
+            stats() : search_counters(), source_seconds(), total_seconds(0.0) {}
         };
-        struct node_ref_compare
+        // With precompute the constructor searches from every node like
+        // it always did. Without it searches only run for the sources
+        // that are asked for, on an internal executor of max_in_flight
+        // threads (0 for one per hardware thread).
+        explicit basic_shortest_path(graph_type& g,
+                                     backend b = backend::automatic,
+                                     bool precompute = true,
+                                     size_t max_in_flight = 0);
+        ~basic_shortest_path();
+        basic_shortest_path(const basic_shortest_path&) = delete;
+        basic_shortest_path& operator=(const basic_shortest_path&) = delete;
+        path_type* get_path(typename graph_type::node& n1, typename graph_type::node& n2);
+        // Same as get_path but returns straight away. Requests for a
+        // source that is already being searched wait for that search
+        // instead of starting their own, so a burst of requests from
+        // the same source costs a single search. Safe to call from
+        // several threads, the graph is not touched anymore.
+        std::future<path_type*> async_get_path(typename graph_type::node& n1,
+                                               typename graph_type::node& n2);
+        backend get_backend() {return _backend;}
+        // A copy, lazy searches keep adding to the stats from the
+        // executor threads
+        stats get_stats();
+        friend std::ostream& operator<< <>(std::ostream& out, basic_shortest_path& s);
+    private:
+        typedef typename graph_type::node node;
+        typedef std::unique_ptr<path_type> path_ptr;
+        typedef shortest_path_part<Cost, Id> part_type;
+        // Paths from one source to every node of its part, by position
+        // in the part. Predecessors point inside the same table.
+        typedef std::vector<path_ptr> table;
+        struct location
         {
-            bool operator()(const graph::node_ref& n1, const graph::node_ref& n2) const
-            {
-                return n1.get() == n2.get();
-            }
+            size_t part;
+            size_t index;
         };
-        struct open_set_order
+        struct waiter
         {
-            bool operator()(const path_ptr& p1, const path_ptr& p2) const
-            {
-                return p1->get_cost() > p2->get_cost();
-            }
+            std::promise<path_type*> result;
+            size_t target; // Position in the part
         };
+        // Runs the searches of a part, compiled for each search type
+        struct fill_tables;
         void compute_paths();
-        graph& _g;
-        bool _ran;
-        // WARNING: Never use std::priority_queue
-        // it is pure garbage. There is no way to
-        // know if an element is in the queue. There
-        // is no way to change the priority of an
-        // element. Having access to the underlying
-        // container could help work around the issue
-        // but there is again no access to the underlying
-        // container. So you are better off implementing
-        // your own priority queue (heap) or use
-        // vector and make_heap
-        typedef std::vector<path_ptr> open_set;
-        typedef std::unordered_map<graph::node_ref,
-                              path_ptr,
-                              node_ref_hash,
-                              node_ref_compare> node_paths;
-        std::unordered_map<graph::node_ref,
-                      std::unique_ptr<node_paths>,
-                      node_ref_hash,
-                      node_ref_compare>
-                      _paths;
+        backend select_backend();
+        template <typename Search>
+        std::unique_ptr<table> search_from(const part_type& part, size_t source, Search& search);
+        void record_source(node& source, double seconds);
+        void search_location(location l);
+        graph_type& _g;
+        backend _backend;
+        stats _stats;
+        bool _precompute;
+        size_t _max_in_flight;
+        // Guards _tables, _stats and _waiting once searches can run
+        // on the executor
+        std::mutex _lock;
+        // Only kept when the searches are not precomputed, nullptr for
+        // the isolated nodes whose only path is known from the start
+        std::vector<std::unique_ptr<part_type>> _parts;
+        // _tables[part][source], nullptr until searched
+        std::vector<std::vector<std::unique_ptr<table>>> _tables;
+        // Read only once built
+        std::unordered_map<node*, location> _locations;
+        // Requests waiting for the search from a given source
+        std::unordered_map<node*, std::vector<waiter>> _waiting;
+        // Last so that it is destroyed first, its workers use the rest
+        std::unique_ptr<executor> _executor;
 };
 
+// Same combinations as basic_graph, compiled in shortest_path.cpp
+extern template class basic_shortest_path<int, int>;
+extern template class basic_shortest_path<int, uint32_t>;
+extern template class basic_shortest_path<float, int>;
+extern template class basic_shortest_path<double, int>;
+extern template class basic_shortest_path<double, uint32_t>;
+typedef basic_shortest_path<int, int> shortest_path;
+
 #endif // __SHORTEST_PATH__
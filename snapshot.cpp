@@ -0,0 +1,222 @@
+#include "snapshot.hpp"
+#include "dijkstra.hpp"
+
+#include <algorithm>
+#include <new>          // For placement new
+#include <stdexcept>
+
+using namespace std;
+
+const uint64_t versioned_graph::idle;
+
+graph_snapshot::graph_snapshot(graph& g, uint64_t version)
+    : _c(g),
+      _version(version),
+      _edge_count(g.edge_count())
+{
+}
+
+bool graph_snapshot::has_node(int id) const
+{
+    return _c.get_index(id) != csr::npos;
+}
+
+bool graph_snapshot::adjacent(int x, int y) const
+{
+    size_t ix = _c.get_index(x);
+    size_t iy = _c.get_index(y);
+    if (ix == csr::npos || iy == csr::npos) {
+        return false;
+    }
+    // Arcs are sorted by target
+    size_t lo = _c.arc_begin(ix);
+    size_t hi = _c.arc_end(ix);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_c.target(mid) < iy) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < _c.arc_end(ix) && _c.target(lo) == iy;
+}
+
+bool graph_snapshot::get_path(int x, int y, vector<int>& ids, int& cost) const
+{
+    ids.clear();
+    size_t ix = _c.get_index(x);
+    size_t iy = _c.get_index(y);
+    if (ix == csr::npos || iy == csr::npos) {
+        return false;
+    }
+    // The engine buffers belong to this query so concurrent
+    // readers of the same snapshot never share anything mutable
+    dijkstra search(_c);
+    search.run(ix, iy);
+    if (search.get_parent(iy) == dijkstra::unreached) {
+        return false;
+    }
+    cost = search.get_distance(iy);
+    for (size_t i = iy; i != ix; i = search.get_parent(i)) {
+        ids.push_back(_c.get_id(i));
+    }
+    ids.push_back(x);
+    reverse(ids.begin(), ids.end());
+    return true;
+}
+
+versioned_graph::versioned_graph(size_t max_readers)
+    : versioned_graph(graph::graph_ptr(new graph), max_readers)
+{
+}
+
+versioned_graph::versioned_graph(graph::graph_ptr g, size_t max_readers)
+    : _g(move(g)),
+      _writer(),
+      _current(nullptr),
+      _epoch(1), // 0 is reserved for idle slots
+      _max_readers(max_readers),
+      _slot_storage(new char[(max_readers + 1) * sizeof(slot)]),
+      _slots(place_slots(_slot_storage.get(), max_readers)),
+      _retired(),
+      _version(0)
+{
+    publish();
+}
+
+versioned_graph::~versioned_graph()
+{
+    // Readers must be gone by now, nothing left to wait for
+    delete _current.load();
+    for (auto& r: _retired) {
+        delete r.first;
+    }
+    for (size_t i = 0; i < _max_readers; ++i) {
+        _slots[i].~slot();
+    }
+}
+
+versioned_graph::slot* versioned_graph::place_slots(char* storage, size_t count)
+{
+    static_assert(sizeof(slot) == 64, "A reader slot is one cache line");
+    // One spare slot worth of bytes covers any misalignment
+    auto address = reinterpret_cast<uintptr_t>(storage);
+    size_t skip = (alignof(slot) - address % alignof(slot)) % alignof(slot);
+    auto slots = reinterpret_cast<slot*>(storage + skip);
+    for (size_t i = 0; i < count; ++i) {
+        new (&slots[i]) slot();
+    }
+    return slots;
+}
+
+versioned_graph::reader versioned_graph::get_reader()
+{
+    for (size_t i = 0; i < _max_readers; ++i) {
+        bool expected = false;
+        if (_slots[i].used.compare_exchange_strong(expected, true)) {
+            return reader(*this, i);
+        }
+    }
+    throw runtime_error("Too many readers registered");
+}
+
+void versioned_graph::update(const function<void(graph&)>& f)
+{
+    lock_guard<mutex> lock(_writer);
+    f(*_g);
+    publish();
+    reclaim();
+}
+
+uint64_t versioned_graph::get_version()
+{
+    lock_guard<mutex> lock(_writer);
+    return _version;
+}
+
+size_t versioned_graph::retired_count()
+{
+    lock_guard<mutex> lock(_writer);
+    reclaim();
+    return _retired.size();
+}
+
+void versioned_graph::publish()
+{
+    auto next = new graph_snapshot(*_g, ++_version);
+    graph_snapshot* previous = _current.exchange(next);
+    // Readers pinned from now on can only load the new snapshot
+    uint64_t retired_at = _epoch.fetch_add(1) + 1;
+    if (previous) {
+        _retired.push_back({previous, retired_at});
+    }
+}
+
+void versioned_graph::reclaim()
+{
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < _max_readers; ++i) {
+        uint64_t e = _slots[i].epoch.load();
+        if (e != idle && e < oldest) {
+            oldest = e;
+        }
+    }
+    auto end = remove_if(_retired.begin(), _retired.end(),
+                         [&](const pair<graph_snapshot*, uint64_t>& r)
+                         {
+                             if (r.second <= oldest) {
+                                 delete r.first;
+                                 return true;
+                             }
+                             return false;
+                         });
+    _retired.erase(end, _retired.end());
+}
+
+versioned_graph::reader::reader(reader&& other)
+    : _g(other._g),
+      _slot(other._slot),
+      _depth(other._depth)
+{
+    other._g = nullptr;
+}
+
+versioned_graph::reader::~reader()
+{
+    if (_g) {
+        _g->_slots[_slot].epoch.store(idle);
+        _g->_slots[_slot].used.store(false);
+    }
+}
+
+versioned_graph::pin versioned_graph::reader::get_pin()
+{
+    auto& s = _g->_slots[_slot];
+    // Nested pins keep the outer epoch, it is the older one
+    if (!_depth++) {
+        s.epoch.store(_g->_epoch.load());
+    }
+    return pin(*this, _g->_current.load());
+}
+
+void versioned_graph::reader::unpin()
+{
+    if (!--_depth) {
+        _g->_slots[_slot].epoch.store(idle);
+    }
+}
+
+versioned_graph::pin::pin(pin&& other)
+    : _r(other._r),
+      _snapshot(other._snapshot)
+{
+    other._r = nullptr;
+}
+
+versioned_graph::pin::~pin()
+{
+    if (_r) {
+        _r->unpin();
+    }
+}
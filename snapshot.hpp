@@ -0,0 +1,130 @@
+#ifndef __SNAPSHOT__
+#define __SNAPSHOT__
+
+// C++ includes
+#include "csr.hpp"
+#include "graph.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>       // For unique_ptr
+#include <mutex>
+#include <utility>      // For pair
+#include <vector>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint64_t
+
+// Immutable copy of a graph at a given version.
+//
+// Everything is addressed by node id since the nodes of the live graph
+// may be deleted while a reader still looks at an old version.
+class graph_snapshot
+{
+    public:
+        graph_snapshot(graph& g, uint64_t version);
+        uint64_t get_version() const {return _version;}
+        size_t node_count() const {return _c.node_count();}
+        size_t edge_count() const {return _edge_count;}
+        bool has_node(int id) const;
+        bool adjacent(int x, int y) const;
+        // Cheapest path from x to y as a list of ids starting with x.
+        // Returns false when y cannot be reached from x.
+        bool get_path(int x, int y, std::vector<int>& ids, int& cost) const;
+    private:
+        csr _c;
+        uint64_t _version;
+        size_t _edge_count;
+};
+
+// Graph shared between one writer at a time and lock free readers.
+//
+// Writers mutate the graph under a mutex and publish a new snapshot by
+// swapping an atomic pointer, so a reader never sees a half applied
+// update. Old snapshots are reclaimed with epochs (RCU style): every
+// reader owns a slot where it writes the global epoch when it pins the
+// current snapshot and clears it when done. A snapshot replaced at
+// epoch E can only be seen by readers pinned before E so it is freed
+// once every slot is either idle or at E or later. Pinning is two
+// atomic stores and a load, no lock, no shared counter bouncing
+// between cores. Publishing rebuilds the snapshot so writers should
+// batch their changes in a single update().
+class versioned_graph
+{
+    public:
+        class reader;
+        // Keeps a snapshot alive for as long as it exists
+        class pin
+        {
+            public:
+                friend class reader;
+                pin(pin&& other);
+                ~pin();
+                pin(const pin&) = delete;
+                pin& operator=(const pin&) = delete;
+                const graph_snapshot& operator*() const {return *_snapshot;}
+                const graph_snapshot* operator->() const {return _snapshot;}
+            private:
+                pin(reader& r, const graph_snapshot* s) : _r(&r), _snapshot(s) {}
+                reader* _r;
+                const graph_snapshot* _snapshot;
+        };
+        // Registration of a reader thread, not meant to be shared
+        // between threads
+        class reader
+        {
+            public:
+                friend class versioned_graph;
+                friend class pin;
+                reader(reader&& other);
+                ~reader();
+                reader(const reader&) = delete;
+                reader& operator=(const reader&) = delete;
+                pin get_pin();
+            private:
+                reader(versioned_graph& g, size_t slot) : _g(&g), _slot(slot), _depth(0) {}
+                void unpin();
+                versioned_graph* _g;
+                size_t _slot;
+                size_t _depth;
+        };
+
+        explicit versioned_graph(size_t max_readers = 64);
+        explicit versioned_graph(graph::graph_ptr g, size_t max_readers = 64);
+        ~versioned_graph();
+        versioned_graph(const versioned_graph&) = delete;
+        versioned_graph& operator=(const versioned_graph&) = delete;
+
+        // Throws runtime_error when max_readers are already registered
+        reader get_reader();
+        // Apply f to the graph under the writer lock then publish
+        void update(const std::function<void(graph&)>& f);
+        uint64_t get_version();
+        // Replaced snapshots still waiting for their readers
+        size_t retired_count();
+    private:
+        static const uint64_t idle = 0;
+        // A cache line each so that two readers never share one
+        struct alignas(64) slot
+        {
+            std::atomic<uint64_t> epoch;
+            std::atomic<bool> used;
+            slot() : epoch(idle), used(false) {}
+        };
+        // new only aligns to 16 bytes before C++17, the slots are
+        // placed at the first 64 bytes boundary of _slot_storage
+        static slot* place_slots(char* storage, size_t count);
+        void publish();
+        void reclaim();
+        graph::graph_ptr _g;
+        std::mutex _writer;
+        std::atomic<graph_snapshot*> _current;
+        std::atomic<uint64_t> _epoch;
+        size_t _max_readers;
+        std::unique_ptr<char[]> _slot_storage;
+        slot* _slots;
+        std::vector<std::pair<graph_snapshot*, uint64_t>> _retired;
+        uint64_t _version;
+};
+
+#endif // __SNAPSHOT__
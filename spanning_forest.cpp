@@ -0,0 +1,175 @@
+#include "spanning_forest.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// C includes
+#include <cstdint>      // For uint32_t, uint64_t
+
+using namespace std;
+
+namespace {
+
+// Below this many edges per thread a pass runs inline
+const size_t edge_grain = 1024;
+const uint64_t no_edge = static_cast<uint64_t>(-1);
+
+// Union-find where every link is a compare and swap. A root is only
+// ever linked under a smaller index so the links cannot form a cycle
+// whatever the interleaving, and find() halves the path as it goes
+// without caring whether another thread got there first.
+class concurrent_union_find
+{
+    public:
+        explicit concurrent_union_find(size_t size) : _parent(size)
+        {
+            for (size_t i = 0; i < size; ++i) {
+                _parent[i].store(i, memory_order_relaxed);
+            }
+        }
+        uint32_t find(uint32_t x)
+        {
+            uint32_t p = _parent[x].load(memory_order_relaxed);
+            while (p != x) {
+                uint32_t gp = _parent[p].load(memory_order_relaxed);
+                _parent[x].compare_exchange_weak(p, gp, memory_order_relaxed);
+                x = p;
+                p = _parent[x].load(memory_order_relaxed);
+            }
+            return x;
+        }
+        // False when x and y were already together
+        bool unite(uint32_t x, uint32_t y)
+        {
+            for (;;) {
+                x = find(x);
+                y = find(y);
+                if (x == y) {
+                    return false;
+                }
+                if (x < y) {
+                    swap(x, y);
+                }
+                // x may have been linked by someone else meanwhile,
+                // then the swap fails and we look again
+                uint32_t expected = x;
+                if (_parent[x].compare_exchange_strong(expected, y, memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+    private:
+        vector<atomic<uint32_t>> _parent;
+};
+
+// Cost first then edge position, the order is total so two edges
+// never compare equal and every component agrees on its cheapest
+uint64_t pack(int cost, uint32_t edge)
+{
+    uint32_t key = static_cast<uint32_t>(cost) ^ 0x80000000u;
+    return (static_cast<uint64_t>(key) << 32) | edge;
+}
+
+void keep_min(atomic<uint64_t>& slot, uint64_t candidate)
+{
+    uint64_t current = slot.load(memory_order_relaxed);
+    while (candidate < current
+           && !slot.compare_exchange_weak(current, candidate, memory_order_relaxed)) {
+    }
+}
+
+}
+
+list<graph::edge_ref> minimum_spanning_forest(graph& g, size_t threads)
+{
+    unordered_map<graph::node*, uint32_t> index;
+    for (auto& n: g.get_nodes()) {
+        index.insert({n.get(), static_cast<uint32_t>(index.size())});
+    }
+    // The edge list contracted round after round, ends are
+    // replaced by the component they belong to
+    struct arc
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t edge;
+        int cost;
+    };
+    vector<graph::edge*> edges;
+    vector<arc> arcs;
+    edges.reserve(g.edge_count());
+    arcs.reserve(g.edge_count());
+    for (auto& e: g.get_edges()) {
+        uint32_t x = index[&e->get_edge().first.get()];
+        uint32_t y = index[&e->get_edge().second.get()];
+        if (x != y) {
+            arcs.push_back({x, y, static_cast<uint32_t>(edges.size()), e->get_cost()});
+        }
+        edges.push_back(e.get());
+    }
+    STATS_ADD(bytes_allocated, arcs.capacity() * sizeof(arc)
+                               + index.size() * 2 * sizeof(uint64_t));
+
+    concurrent_union_find components(index.size());
+    vector<atomic<uint64_t>> cheapest(index.size());
+    for (auto& c: cheapest) {
+        c.store(no_edge, memory_order_relaxed);
+    }
+    vector<bool> chosen(edges.size(), false);
+    mutex lock;
+    while (!arcs.empty()) {
+        parallel_for(0, arcs.size(), threads, [&](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; ++i) {
+                uint64_t candidate = pack(arcs[i].cost, i);
+                keep_min(cheapest[arcs[i].x], candidate);
+                keep_min(cheapest[arcs[i].y], candidate);
+            }
+        }, edge_grain);
+        // Both ends of an edge may pick it, the second unite fails
+        parallel_for(0, arcs.size(), threads, [&](size_t lo, size_t hi)
+        {
+            vector<uint32_t> linked;
+            for (size_t i = lo; i < hi; ++i) {
+                uint64_t pick = cheapest[arcs[i].x].load(memory_order_relaxed);
+                if (pick == no_edge || (pick & 0xffffffff) != i) {
+                    pick = cheapest[arcs[i].y].load(memory_order_relaxed);
+                    if (pick == no_edge || (pick & 0xffffffff) != i) {
+                        continue;
+                    }
+                }
+                if (components.unite(arcs[i].x, arcs[i].y)) {
+                    linked.push_back(arcs[i].edge);
+                }
+            }
+            lock_guard<mutex> guard(lock);
+            for (auto e: linked) {
+                chosen[e] = true;
+            }
+        }, edge_grain);
+        // Contract, only the edges between two components survive
+        size_t kept = 0;
+        for (auto& a: arcs) {
+            cheapest[a.x].store(no_edge, memory_order_relaxed);
+            cheapest[a.y].store(no_edge, memory_order_relaxed);
+            uint32_t x = components.find(a.x);
+            uint32_t y = components.find(a.y);
+            if (x != y) {
+                arcs[kept++] = {x, y, a.edge, a.cost};
+            }
+        }
+        arcs.resize(kept);
+    }
+
+    list<graph::edge_ref> forest;
+    for (size_t e = 0; e < edges.size(); ++e) {
+        if (chosen[e]) {
+            forest.push_back(*edges[e]);
+        }
+    }
+    return forest;
+}
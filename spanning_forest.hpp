@@ -0,0 +1,28 @@
+#ifndef __SPANNING_FOREST__
+#define __SPANNING_FOREST__
+
+// C++ includes
+#include "graph.hpp"
+#include <list>
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Minimum spanning forest with Boruvka's algorithm, one tree per
+// connected component.
+//
+// Every round each component picks its cheapest outgoing edge, all
+// the picked edges join the forest at once and the components they
+// link are merged. Picking is a parallel pass over the edges where
+// the cheapest edge of a component is kept with a compare and swap,
+// merging goes through a lock free union-find, and the edges left
+// inside a component are dropped before the next round so later
+// rounds only see the contracted graph. The number of components at
+// least halves every round.
+//
+// Ties are broken by position in get_edges() so the forest is the
+// same whatever the number of threads. Edges are returned in that
+// order and stay owned by the graph.
+std::list<graph::edge_ref> minimum_spanning_forest(graph& g, size_t threads = 0);
+
+#endif // __SPANNING_FOREST__
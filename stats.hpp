@@ -0,0 +1,81 @@
+#ifndef __STATS__
+#define __STATS__
+
+// C includes
+#include <cstddef>      // For size_t
+
+// Counters filled by the search engines (bfs, dijkstra).
+//
+// They are only collected when the code is built with
+// -DSHORTEST_PATH_STATS. Otherwise the STATS_* macros expand to nothing
+// and the engines compile exactly as if they were not there. When
+// enabled every thread bumps its own copy so the hot loops never share
+// a cache line; the caller reads the counters of its thread once the
+// search is done. Engines that fan out to worker threads sum locally
+// and add the totals from the calling thread.
+struct search_counters
+{
+    size_t nodes_settled;
+    size_t edges_relaxed;
+    size_t heap_pushes;
+    size_t heap_pops;
+    size_t decrease_keys;
+    size_t peak_open_set;
+    size_t bytes_allocated;
+    // Most threads a single search ran on
+    size_t peak_threads;
+
+    search_counters()
+        : nodes_settled(0),
+          edges_relaxed(0),
+          heap_pushes(0),
+          heap_pops(0),
+          decrease_keys(0),
+          peak_open_set(0),
+          bytes_allocated(0),
+          peak_threads(0) {}
+    search_counters& operator+=(const search_counters& other);
+};
+
+inline search_counters& search_counters::operator+=(const search_counters& other)
+{
+    nodes_settled += other.nodes_settled;
+    edges_relaxed += other.edges_relaxed;
+    heap_pushes += other.heap_pushes;
+    heap_pops += other.heap_pops;
+    decrease_keys += other.decrease_keys;
+    if (other.peak_open_set > peak_open_set) {
+        peak_open_set = other.peak_open_set;
+    }
+    bytes_allocated += other.bytes_allocated;
+    if (other.peak_threads > peak_threads) {
+        peak_threads = other.peak_threads;
+    }
+    return *this;
+}
+
+#ifdef SHORTEST_PATH_STATS
+
+inline search_counters& thread_counters()
+{
+    static thread_local search_counters counters;
+    return counters;
+}
+
+#define STATS_ADD(field, n) (thread_counters().field += (n))
+#define STATS_MAX(field, n)                             \
+    do {                                                \
+        size_t stats_value = (n);                       \
+        if (stats_value > thread_counters().field) {    \
+            thread_counters().field = stats_value;      \
+        }                                               \
+    } while (0)
+
+#else
+
+#define STATS_ADD(field, n) ((void)0)
+#define STATS_MAX(field, n) ((void)0)
+
+#endif // SHORTEST_PATH_STATS
+
+#endif // __STATS__
@@ -0,0 +1,87 @@
+#include "bfs.hpp"
+#include "csr.hpp"
+#include "graph.hpp"
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(bfs)
+{
+};
+
+TEST(bfs, linear)
+{
+    // a <-> b <-> c <-> d    e
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 1);
+    g.add_edge(c, d, 1);
+    csr s(g);
+    bfs search(s);
+    search.run(0);
+    CHECK_EQUAL(search.get_depth(0), 0);
+    CHECK_EQUAL(search.get_depth(3), 3);
+    CHECK_EQUAL(search.get_parent(3), 2);
+    CHECK_EQUAL(search.get_parent(0), 0);
+    CHECK_EQUAL(search.get_parent(4), bfs::unreached);
+    CHECK_EQUAL(search.get_depth(4), bfs::unreached);
+    CHECK_EQUAL(search.get_order().size(), 4);
+    CHECK_EQUAL(search.get_order().front(), 0);
+    // The same engine can be reused from another source
+    search.run(2);
+    CHECK_EQUAL(search.get_depth(0), 2);
+    CHECK_EQUAL(search.get_parent(1), 2);
+};
+
+TEST(bfs, bottom_up)
+{
+    // A star explores all its edges from the very first
+    // level so the search must go bottom up
+    graph g;
+    auto& center = g.add_node();
+    for (size_t i = 0; i < 100; ++i) {
+        g.add_edge(center, g.add_node());
+    }
+    csr s(g);
+    bfs search(s);
+    search.run(0);
+    CHECK(search.bottom_up_steps() > 0);
+    CHECK_EQUAL(search.get_order().size(), 101);
+    for (size_t i = 1; i < 101; ++i) {
+        CHECK_EQUAL(search.get_depth(i), 1);
+        CHECK_EQUAL(search.get_parent(i), 0);
+    }
+    // From a leaf the first level is tiny compared to what is left
+    search.run(1);
+    CHECK(search.top_down_steps() > 0);
+    CHECK_EQUAL(search.get_depth(2), 2);
+};
+
+TEST(bfs, threads)
+{
+    // Results do not depend on the number of threads
+    auto g = graph::generate_graph(300, 0.02, 1, 2);
+    csr s(*g);
+    bfs serial(s, 1);
+    bfs parallel(s, 4, 14, 24);
+    for (size_t source = 0; source < s.node_count(); source += 37) {
+        serial.run(source);
+        parallel.run(source);
+        CHECK_EQUAL(serial.get_order().size(), parallel.get_order().size());
+        for (size_t i = 0; i < s.node_count(); ++i) {
+            CHECK_EQUAL(serial.get_depth(i), parallel.get_depth(i));
+        }
+    }
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
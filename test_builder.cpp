@@ -0,0 +1,97 @@
+#include "builder.hpp"
+#include "graph.hpp"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(builder)
+{
+};
+
+TEST(builder, seal)
+{
+    graph_builder b(3);
+    CHECK_EQUAL(b.shard_count(), 4);
+    int x = b.add_node();
+    int y = b.add_node();
+    b.add_node(10);
+    b.add_edge(x, y, 4);
+    b.add_edge(y, 10, 2);
+    CHECK_EQUAL(b.node_count(), 3);
+    CHECK_EQUAL(b.edge_count(), 2);
+    auto g = b.seal();
+    CHECK_EQUAL(b.node_count(), 0);
+    CHECK_EQUAL(g->node_count(), 3);
+    CHECK_EQUAL(g->edge_count(), 2);
+    auto& nodes = g->get_nodes();
+    auto& n0 = *nodes.front();
+    auto& n10 = *nodes.back();
+    CHECK_EQUAL(n0.get_id(), 0);
+    CHECK_EQUAL(n10.get_id(), 10);
+    CHECK(g->connected(n0, n10));
+    CHECK_EQUAL(g->get_edges().front()->get_cost(), 4);
+    // Generated ids go on after the explicit ones
+    CHECK_EQUAL(b.add_node(), 11);
+    CHECK_EQUAL(g->add_node().get_id(), 11);
+};
+
+TEST(builder, unknown)
+{
+    graph_builder b;
+    b.add_node();
+    b.add_edge(0, 1);
+    CHECK_THROWS(runtime_error, b.seal());
+    // Nothing is lost, adding the missing node is enough to seal
+    CHECK_EQUAL(b.node_count(), 1u);
+    CHECK_EQUAL(b.edge_count(), 1u);
+    CHECK_THROWS(runtime_error, b.seal());
+    b.add_node(1);
+    auto g = b.seal();
+    CHECK_EQUAL(g->node_count(), 2u);
+    CHECK_EQUAL(g->edge_count(), 1u);
+    CHECK_EQUAL(b.node_count(), 0u);
+    CHECK_EQUAL(b.edge_count(), 0u);
+};
+
+TEST(builder, concurrent)
+{
+    // Every producer makes a chain of its own nodes
+    graph_builder b;
+    const size_t producers = 8;
+    const size_t length = 2000;
+    vector<thread> threads;
+    for (size_t t = 0; t < producers; ++t) {
+        threads.push_back(thread([&]()
+        {
+            int previous = b.add_node();
+            for (size_t i = 1; i < length; ++i) {
+                int current = b.add_node();
+                b.add_edge(previous, current, 1);
+                previous = current;
+            }
+        }));
+    }
+    for (auto& t: threads) {
+        t.join();
+    }
+    auto g = b.seal();
+    CHECK_EQUAL(g->node_count(), producers * length);
+    CHECK_EQUAL(g->edge_count(), producers * (length - 1));
+    CHECK_EQUAL(g->component_count(), producers);
+    // Ids are unique and dense
+    int expected = 0;
+    for (auto& n: g->get_nodes()) {
+        CHECK_EQUAL(n->get_id(), expected++);
+    }
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,106 @@
+#include "bfs.hpp"
+#include "compressed_csr.hpp"
+#include "csr.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(compressed_csr)
+{
+};
+
+// Every arc of c decodes back from z in the same order
+static void check_arcs(const csr& c, const compressed_csr& z)
+{
+    CHECK_EQUAL(z.node_count(), c.node_count());
+    CHECK_EQUAL(z.arc_count(), c.arc_count());
+    CHECK_EQUAL(z.min_cost(), c.min_cost());
+    CHECK_EQUAL(z.max_cost(), c.max_cost());
+    for (size_t i = 0; i < c.node_count(); ++i) {
+        CHECK_EQUAL(z.get_id(i), c.get_id(i));
+        CHECK_EQUAL(z.get_index(c.get_id(i)), i);
+        CHECK_EQUAL(z.degree(i), c.degree(i));
+        size_t a = c.arc_begin(i);
+        for (auto arc: z.arcs(i)) {
+            CHECK(a < c.arc_end(i));
+            CHECK_EQUAL(arc.target, c.target(a));
+            CHECK_EQUAL(arc.cost, c.cost(a));
+            ++a;
+        }
+        CHECK_EQUAL(a, c.arc_end(i));
+    }
+}
+
+TEST(compressed_csr, empty)
+{
+    graph g;
+    compressed_csr z(g);
+    CHECK_EQUAL(z.node_count(), 0);
+    CHECK_EQUAL(z.arc_count(), 0);
+    CHECK_EQUAL(z.get_index(3), csr::npos);
+};
+
+TEST(compressed_csr, costs)
+{
+    // Uniform, one byte, two bytes, four bytes and negative costs
+    int ranges[][2] = {{5, 6}, {0, 200}, {-1000, 1000}, {-100000, 100000}};
+    for (auto& r: ranges) {
+        auto g = graph::generate_graph(200, 0.05, r[0], r[1], 11);
+        // Some isolated nodes and a node linked to itself
+        g->add_node();
+        auto& n = g->add_node();
+        g->add_edge(n, n, r[0]);
+        csr c(*g);
+        check_arcs(c, compressed_csr(c));
+    }
+};
+
+TEST(compressed_csr, reorder)
+{
+    // Neighbors close to each other after a reorder, the gaps fit
+    // in a byte and the costs in another
+    auto g = graph::generate_graph(2000, 0.01, 1, 100, 3);
+    g->reorder(graph::ordering::reverse_cuthill_mckee);
+    csr c(*g);
+    compressed_csr z(c);
+    check_arcs(c, z);
+    size_t plain = c.arc_count() * (sizeof(csr::index) + sizeof(int))
+                   + (c.node_count() + 1) * sizeof(size_t);
+    CHECK(z.memory_bytes() * 2 < plain);
+};
+
+TEST(compressed_csr, search)
+{
+    auto g = graph::generate_graph(300, 0.02, 0, 30, 7);
+    csr c(*g);
+    compressed_csr z(c);
+    dijkstra plain(c);
+    basic_dijkstra<compressed_csr> packed(z);
+    bfs plain_bfs(c, 1);
+    basic_bfs<compressed_csr> packed_bfs(z, 4);
+    for (size_t source = 0; source < c.node_count(); source += 7) {
+        plain.run(source);
+        packed.run(source);
+        plain_bfs.run(source);
+        packed_bfs.run(source);
+        CHECK(plain.get_order() == packed.get_order());
+        for (size_t i = 0; i < c.node_count(); ++i) {
+            CHECK_EQUAL(plain.get_parent(i), packed.get_parent(i));
+            if (plain.get_parent(i) != dijkstra::unreached) {
+                CHECK_EQUAL(plain.get_distance(i), packed.get_distance(i));
+            }
+            CHECK_EQUAL(plain_bfs.get_depth(i), packed_bfs.get_depth(i));
+        }
+    }
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,81 @@
+#include "csr.hpp"
+#include "graph.hpp"
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(csr)
+{
+};
+
+TEST(csr, empty)
+{
+    graph g;
+    csr c(g);
+    CHECK_EQUAL(c.node_count(), 0);
+    CHECK_EQUAL(c.arc_count(), 0);
+    CHECK(c.has_uniform_cost());
+};
+
+TEST(csr, create)
+{
+    // a <-3-> b <-1-> c    d
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_edge(b, c, 1);
+    g.add_edge(a, b, 3);
+    csr s(g);
+    CHECK_EQUAL(s.node_count(), 4);
+    CHECK_EQUAL(s.arc_count(), 4);
+    CHECK_EQUAL(s.get_index(a), 0);
+    CHECK_EQUAL(s.get_index(d), 3);
+    CHECK(s.get_node(2) == c);
+    CHECK_EQUAL(s.degree(0), 1);
+    CHECK_EQUAL(s.degree(1), 2);
+    CHECK_EQUAL(s.degree(3), 0);
+    // Arcs are sorted by target whatever the insertion order
+    size_t arc = s.arc_begin(1);
+    CHECK_EQUAL(s.target(arc), 0);
+    CHECK_EQUAL(s.cost(arc), 3);
+    CHECK_EQUAL(s.target(arc + 1), 2);
+    CHECK_EQUAL(s.cost(arc + 1), 1);
+    CHECK_EQUAL(s.min_cost(), 1);
+    CHECK_EQUAL(s.max_cost(), 3);
+    CHECK(!s.has_uniform_cost());
+    graph::node outsider(42);
+    CHECK_EQUAL(s.get_index(outsider), csr::npos);
+};
+
+TEST(csr, members)
+{
+    // a <-3-> b <-1-> c <-2-> d
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_edge(a, b, 3);
+    g.add_edge(b, c, 1);
+    g.add_edge(c, d, 2);
+    csr whole(g);
+    // Only the arcs between members are kept
+    csr part(whole, {3, 2, 1});
+    CHECK_EQUAL(part.node_count(), 3);
+    CHECK_EQUAL(part.arc_count(), 4);
+    CHECK(part.get_node(0) == d);
+    CHECK_EQUAL(part.get_index(b), 2);
+    CHECK_EQUAL(part.get_index(a), csr::npos);
+    CHECK_EQUAL(part.degree(2), 1);
+    CHECK_EQUAL(part.min_cost(), 1);
+    CHECK_EQUAL(part.max_cost(), 2);
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,133 @@
+#include "csr.hpp"
+#include "delta_stepping.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(delta_stepping)
+{
+};
+
+TEST(delta_stepping, shortcut)
+{
+    // a <-1-> b <-1-> c <-1-> d    e
+    //  \__________5__________/
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 1);
+    g.add_edge(c, d, 1);
+    g.add_edge(a, d, 5);
+    csr s(g);
+    delta_stepping search(s, 1, 2);
+    CHECK_EQUAL(search.get_delta(), 2);
+    search.run(0);
+    CHECK_EQUAL(search.get_distance(3), 3);
+    CHECK_EQUAL(search.get_parent(3), 2);
+    CHECK_EQUAL(search.get_parent(0), 0);
+    CHECK_EQUAL(search.get_parent(4), delta_stepping::unreached);
+    CHECK_EQUAL(search.get_order().size(), 4);
+    CHECK_EQUAL(search.get_order().front(), 0);
+};
+
+TEST(delta_stepping, zero_cost)
+{
+    // Parents come before their children even at equal distance
+    // c <-0-> b <-0-> a
+    graph g;
+    auto& c = g.add_node();
+    auto& b = g.add_node();
+    auto& a = g.add_node();
+    g.add_edge(a, b, 0);
+    g.add_edge(b, c, 0);
+    csr s(g);
+    delta_stepping search(s);
+    CHECK_EQUAL(search.get_delta(), 1);
+    search.run(2);
+    CHECK(search.get_order() == vector<size_t>({2, 1, 0}));
+    CHECK_EQUAL(search.get_distance(0), 0);
+};
+
+TEST(delta_stepping, negative)
+{
+    graph g;
+    g.add_edge(g.add_node(), g.add_node(), -1);
+    csr s(g);
+    CHECK_THROWS(runtime_error, delta_stepping search(s));
+};
+
+TEST(delta_stepping, dijkstra)
+{
+    // Same distances as Dijkstra whatever delta and the thread count
+    auto g = graph::generate_graph(200, 0.05, 1, 50, 3);
+    csr s(*g);
+    dijkstra reference(s);
+    delta_stepping automatic(s);
+    delta_stepping narrow(s, 4, 1);
+    delta_stepping wide(s, 2, 1000);
+    CHECK(automatic.get_delta() > 0);
+    for (size_t source = 0; source < s.node_count(); source += 13) {
+        reference.run(source);
+        automatic.run(source);
+        narrow.run(source);
+        wide.run(source);
+        CHECK_EQUAL(reference.get_order().size(), automatic.get_order().size());
+        for (size_t i = 0; i < s.node_count(); ++i) {
+            if (reference.get_parent(i) == dijkstra::unreached) {
+                CHECK_EQUAL(automatic.get_parent(i), delta_stepping::unreached);
+                continue;
+            }
+            CHECK_EQUAL(reference.get_distance(i), automatic.get_distance(i));
+            CHECK_EQUAL(reference.get_distance(i), narrow.get_distance(i));
+            CHECK_EQUAL(reference.get_distance(i), wide.get_distance(i));
+            // Without zero cost arcs the tree is deterministic too
+            CHECK_EQUAL(automatic.get_parent(i), narrow.get_parent(i));
+        }
+    }
+};
+
+TEST(delta_stepping, heavy_edge)
+{
+    // A clique of cheap edges and a single huge one: delta ends up at
+    // 1 and the far node is two billion buckets away
+    graph g;
+    vector<graph::node*> nodes;
+    for (size_t i = 0; i < 50; ++i) {
+        nodes.push_back(&g.add_node());
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = i + 1; j < nodes.size(); ++j) {
+            g.add_edge(*nodes[i], *nodes[j], 1 + (i + j) % 3);
+        }
+    }
+    auto& far = g.add_node();
+    g.add_edge(*nodes[0], far, 2000000000);
+    csr s(g);
+    delta_stepping search(s);
+    CHECK_EQUAL(search.get_delta(), 1);
+    dijkstra reference(s);
+    for (size_t source = 0; source < s.node_count(); source += 10) {
+        search.run(source);
+        reference.run(source);
+        for (size_t i = 0; i < s.node_count(); ++i) {
+            CHECK_EQUAL(reference.get_distance(i), search.get_distance(i));
+        }
+    }
+    CHECK_EQUAL(search.get_order().size(), s.node_count());
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,53 @@
+#include "csr.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(dijkstra)
+{
+};
+
+TEST(dijkstra, shortcut)
+{
+    // a <-1-> b <-1-> c <-1-> d    e
+    //  \__________5__________/
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 1);
+    g.add_edge(c, d, 1);
+    g.add_edge(a, d, 5);
+    csr s(g);
+    dijkstra search(s);
+    search.run(0);
+    CHECK_EQUAL(search.get_distance(3), 3);
+    CHECK_EQUAL(search.get_parent(3), 2);
+    CHECK_EQUAL(search.get_parent(0), 0);
+    CHECK_EQUAL(search.get_parent(4), dijkstra::unreached);
+    CHECK_EQUAL(search.get_order().size(), 4);
+    CHECK_EQUAL(search.get_order().front(), 0);
+    CHECK_EQUAL(search.get_order().back(), 3);
+    g.set_edge_value(**g.get_edge_iterator(a, d), 2);
+    csr s2(g);
+    dijkstra search2(s2);
+    search2.run(0);
+    CHECK_EQUAL(search2.get_distance(3), 2);
+    CHECK_EQUAL(search2.get_parent(3), 0);
+    // The engine can be reused from another source
+    search2.run(2);
+    CHECK_EQUAL(search2.get_distance(0), 2);
+    CHECK_EQUAL(search2.get_parent(4), dijkstra::unreached);
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
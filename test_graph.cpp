@@ -205,6 +205,113 @@ TEST(graph, gen)
     CHECK(g->edge_count() > (0.5 * expectation));
 };
 
+TEST(graph, delete_node_edges)
+{
+    // a <-> b <-> c, removing b takes both edges with it
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    g.add_edge(a, b);
+    g.add_edge(b, c);
+    g.delete_node(b);
+    CHECK_EQUAL(g.node_count(), 2);
+    CHECK_EQUAL(g.edge_count(), 0);
+    CHECK_EQUAL(a.has_neighbors(), false);
+    CHECK_EQUAL(c.has_neighbors(), false);
+};
+
+TEST(graph, components)
+{
+    // a <-> b    c <-> d    e
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    auto& e = g.add_node();
+    CHECK_EQUAL(g.component_count(), 5);
+    g.add_edge(a, b);
+    g.add_edge(c, d);
+    CHECK_EQUAL(g.component_count(), 3);
+    CHECK(g.connected(a, b));
+    CHECK(g.connected(d, c));
+    CHECK(!g.connected(a, c));
+    CHECK(!g.connected(e, a));
+    CHECK(g.connected(e, e));
+    g.add_edge(b, c);
+    CHECK_EQUAL(g.component_count(), 2);
+    CHECK(g.connected(a, d));
+    CHECK(&g.find_component(a) == &g.find_component(d));
+    // Deleting an edge splits the component again
+    g.delete_edge(b, c);
+    CHECK_EQUAL(g.component_count(), 3);
+    CHECK(!g.connected(a, d));
+    g.delete_node(e);
+    CHECK_EQUAL(g.component_count(), 2);
+    g.add_edge(a, d);
+    CHECK_EQUAL(g.component_count(), 1);
+    CHECK(g.connected(b, c));
+};
+
+TEST(graph, reorder)
+{
+    // Chain inserted out of order: n0 <-> n3 <-> n1 <-> n4 <-> n2
+    graph g;
+    vector<graph::node*> n;
+    for (size_t i = 0; i < 5; ++i) {
+        n.push_back(&g.add_node());
+    }
+    g.add_edge(*n[0], *n[3]);
+    g.add_edge(*n[3], *n[1]);
+    g.add_edge(*n[1], *n[4]);
+    g.add_edge(*n[4], *n[2]);
+    CHECK(g.get_permutation().empty());
+
+    auto ids = [&]()
+    {
+        vector<int> result;
+        for (auto& node: g.get_nodes()) {
+            result.push_back(node->get_id());
+        }
+        return result;
+    };
+    g.reorder(graph::ordering::breadth_first);
+    CHECK(ids() == vector<int>({0, 3, 1, 4, 2}));
+    CHECK(g.get_permutation() == vector<size_t>({0, 3, 1, 4, 2}));
+
+    // Already a chain, reversed from the last low degree end
+    g.reorder(graph::ordering::reverse_cuthill_mckee);
+    CHECK(ids() == vector<int>({2, 4, 1, 3, 0}));
+    CHECK(g.get_permutation() == vector<size_t>({4, 3, 2, 1, 0}));
+
+    g.reorder(graph::ordering::degree);
+    CHECK(ids() == vector<int>({4, 1, 3, 2, 0}));
+
+    // Only the order changed
+    CHECK_EQUAL(g.node_count(), 5);
+    CHECK_EQUAL(g.edge_count(), 4);
+    CHECK(g.adjacent(*n[1], *n[4]));
+    CHECK(g.connected(*n[0], *n[2]));
+};
+
+TEST(graph, typed)
+{
+    // Fractional costs and unsigned ids
+    auto g = basic_graph<double, uint32_t>::generate_graph(50, 0.2, 0.5, 1.5, 3);
+    CHECK_EQUAL(g->node_count(), 50);
+    bool fractional = false;
+    for (auto& e: g->get_edges()) {
+        CHECK(e->get_cost() >= 0.5 && e->get_cost() < 1.5);
+        fractional |= (e->get_cost() != static_cast<int>(e->get_cost()));
+    }
+    CHECK(fractional);
+    uint32_t id = 0;
+    for (auto& n: g->get_nodes()) {
+        CHECK_EQUAL(n->get_id(), id++);
+    }
+};
+
 int main(int ac, char** av)
 {
     return CommandLineTestRunner::RunAllTests(ac, av);
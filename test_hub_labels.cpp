@@ -0,0 +1,95 @@
+#include "csr.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "hub_labels.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(hub_labels)
+{
+};
+
+TEST(hub_labels, line)
+{
+    // a <-3-> b <-1-> c    d
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_edge(a, b, 3);
+    g.add_edge(b, c, 1);
+    hub_labels h(g);
+    CHECK_EQUAL(h.distance(a.get_id(), c.get_id()), 4);
+    CHECK_EQUAL(h.distance(c.get_id(), a.get_id()), 4);
+    CHECK_EQUAL(h.distance(b.get_id(), b.get_id()), 0);
+    CHECK_EQUAL(h.distance(a.get_id(), d.get_id()), hub_labels::unreachable);
+    CHECK_EQUAL(h.distance(a.get_id(), 1000), hub_labels::unreachable);
+    vector<int> ids;
+    int cost = 0;
+    CHECK(h.get_path(a.get_id(), c.get_id(), ids, cost));
+    CHECK_EQUAL(cost, 4);
+    CHECK(ids == vector<int>({a.get_id(), b.get_id(), c.get_id()}));
+    CHECK(!h.get_path(a.get_id(), d.get_id(), ids, cost));
+    CHECK(ids.empty());
+};
+
+TEST(hub_labels, negative)
+{
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    g.add_edge(a, b, -1);
+    CHECK_THROWS(runtime_error, hub_labels h(g));
+};
+
+TEST(hub_labels, dijkstra)
+{
+    // Same distances as a plain search and paths that really cost
+    // what the oracle says
+    auto g = graph::generate_graph(80, 0.05, 0, 20, 21);
+    hub_labels h(*g);
+    csr c(*g);
+    dijkstra search(c);
+    vector<int> ids;
+    for (size_t i = 0; i < c.node_count(); ++i) {
+        search.run(i);
+        for (size_t j = 0; j < c.node_count(); ++j) {
+            int expected = search.get_parent(j) == dijkstra::unreached
+                           ? hub_labels::unreachable : search.get_distance(j);
+            CHECK_EQUAL(h.distance(c.get_id(i), c.get_id(j)), expected);
+            int cost = 0;
+            if (!h.get_path(c.get_id(i), c.get_id(j), ids, cost)) {
+                continue;
+            }
+            CHECK_EQUAL(cost, expected);
+            CHECK_EQUAL(ids.front(), c.get_id(i));
+            CHECK_EQUAL(ids.back(), c.get_id(j));
+            int total = 0;
+            for (size_t k = 1; k < ids.size(); ++k) {
+                size_t x = c.get_index(ids[k - 1]);
+                size_t y = c.get_index(ids[k]);
+                size_t a = c.arc_begin(x);
+                while (a < c.arc_end(x) && c.target(a) != y) {
+                    ++a;
+                }
+                CHECK(a < c.arc_end(x));
+                total += c.cost(a);
+            }
+            CHECK_EQUAL(total, cost);
+        }
+    }
+    // Far below the n^2 entries of the full tables
+    CHECK(h.label_count() < c.node_count() * c.node_count());
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,78 @@
+#include "graph.hpp"
+#include "partition.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(partition)
+{
+};
+
+TEST(partition, balance)
+{
+    auto g = graph::generate_graph(200, 0.05, 0, 10, 5);
+    auto part = partition_graph(*g, 4);
+    CHECK_EQUAL(part.size(), g->node_count());
+    vector<size_t> size(4, 0);
+    for (auto& p: part) {
+        CHECK(p.second < 4);
+        ++size[p.second];
+    }
+    for (auto s: size) {
+        CHECK(s > 0);
+        CHECK(s <= 200 / 4 + 200 / 4 / 20 + 1);
+    }
+};
+
+TEST(partition, clusters)
+{
+    // Four dense clusters of 25 nodes with a single edge from one to
+    // the next, added round robin so that the ids of a cluster are
+    // spread all over
+    graph g;
+    vector<graph::node*> nodes;
+    for (size_t i = 0; i < 100; ++i) {
+        nodes.push_back(&g.add_node());
+    }
+    srand(3);
+    for (size_t i = 0; i < 100; ++i) {
+        for (size_t j = i + 4; j < 100; j += 4) {
+            if (rand() % 3 == 0) {
+                g.add_edge(*nodes[i], *nodes[j], 1);
+            }
+        }
+    }
+    for (size_t c = 0; c < 3; ++c) {
+        g.add_edge(*nodes[c], *nodes[c + 1], 1);
+    }
+    auto part = partition_graph(g, 4);
+    // Splitting by id cuts almost every edge
+    unordered_map<int, size_t> naive;
+    for (auto& n: g.get_nodes()) {
+        naive[n->get_id()] = n->get_id() * 4 / 100;
+    }
+    CHECK(edge_cut(g, part) < 20);
+    CHECK(edge_cut(g, part) < edge_cut(g, naive));
+};
+
+TEST(partition, small)
+{
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    g.add_edge(a, b, 1);
+    auto part = partition_graph(g, 4);
+    CHECK_EQUAL(part.size(), 2u);
+    CHECK_EQUAL(edge_cut(g, part), part[a.get_id()] == part[b.get_id()] ? 0u : 1u);
+    CHECK_EQUAL(partition_graph(g, 0).size(), 2u);
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
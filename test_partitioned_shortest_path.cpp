@@ -0,0 +1,151 @@
+#include "csr.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "partitioned_shortest_path.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+// C includes
+#include <cerrno>
+#include <sys/wait.h>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(partitioned_shortest_path)
+{
+};
+
+TEST(partitioned_shortest_path, line)
+{
+    // a <-3-> b <-1-> c <-2-> d    e
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    auto& e = g.add_node();
+    g.add_edge(a, b, 3);
+    g.add_edge(b, c, 1);
+    g.add_edge(c, d, 2);
+    partitioned_shortest_path s(g, 2);
+    CHECK_EQUAL(s.worker_count(), 2u);
+    CHECK_EQUAL(s.distance(a.get_id(), d.get_id()), 6);
+    CHECK_EQUAL(s.distance(d.get_id(), a.get_id()), 6);
+    CHECK_EQUAL(s.distance(b.get_id(), b.get_id()), 0);
+    CHECK_EQUAL(s.distance(a.get_id(), e.get_id()), partitioned_shortest_path::unreachable);
+    CHECK_EQUAL(s.distance(a.get_id(), 1000), partitioned_shortest_path::unreachable);
+    vector<int> ids;
+    int cost = 0;
+    CHECK(s.get_path(a.get_id(), d.get_id(), ids, cost));
+    CHECK_EQUAL(cost, 6);
+    CHECK(ids == vector<int>({a.get_id(), b.get_id(), c.get_id(), d.get_id()}));
+    CHECK(!s.get_path(a.get_id(), e.get_id(), ids, cost));
+    CHECK(ids.empty());
+};
+
+TEST(partitioned_shortest_path, negative)
+{
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    g.add_edge(a, b, -1);
+    CHECK_THROWS(runtime_error, partitioned_shortest_path s(g, 2));
+};
+
+TEST(partitioned_shortest_path, dijkstra)
+{
+    // Same distances as a search over the whole graph and paths that
+    // really cost what they say, wherever they cross the parts
+    auto g = graph::generate_graph(60, 0.06, 0, 20, 8);
+    partitioned_shortest_path s(*g, 3);
+    CHECK(s.boundary_count() > 0);
+    csr c(*g);
+    dijkstra search(c);
+    vector<int> ids;
+    for (size_t i = 0; i < c.node_count(); ++i) {
+        search.run(i);
+        for (size_t j = 0; j < c.node_count(); ++j) {
+            int expected = search.get_parent(j) == dijkstra::unreached
+                           ? partitioned_shortest_path::unreachable : search.get_distance(j);
+            int cost = 0;
+            bool found = s.get_path(c.get_id(i), c.get_id(j), ids, cost);
+            CHECK_EQUAL(found, expected != partitioned_shortest_path::unreachable);
+            if (!found) {
+                continue;
+            }
+            CHECK_EQUAL(cost, expected);
+            CHECK_EQUAL(ids.front(), c.get_id(i));
+            CHECK_EQUAL(ids.back(), c.get_id(j));
+            int total = 0;
+            for (size_t k = 1; k < ids.size(); ++k) {
+                size_t x = c.get_index(ids[k - 1]);
+                size_t y = c.get_index(ids[k]);
+                size_t a = c.arc_begin(x);
+                while (a < c.arc_end(x) && c.target(a) != y) {
+                    ++a;
+                }
+                CHECK(a < c.arc_end(x));
+                total += c.cost(a);
+            }
+            CHECK_EQUAL(total, cost);
+        }
+    }
+};
+
+TEST(partitioned_shortest_path, heavy)
+{
+    // Two arcs of 2000000000 in a row do not fit in an int, going over
+    // both must not wrap around to a short cut
+    graph g;
+    vector<graph::node*> nodes;
+    for (size_t i = 0; i < 8; ++i) {
+        nodes.push_back(&g.add_node());
+    }
+    for (size_t i = 0; i + 1 < 4; ++i) {
+        g.add_edge(*nodes[i], *nodes[i + 1], 1);
+        g.add_edge(*nodes[i + 4], *nodes[i + 5], 1);
+    }
+    g.add_edge(*nodes[3], *nodes[4], 2000000000);
+    g.add_edge(*nodes[7], *nodes[0], 2000000000);
+    for (size_t workers = 1; workers <= 4; ++workers) {
+        partitioned_shortest_path s(g, workers);
+        csr c(g);
+        dijkstra search(c);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            search.run(c.get_index(*nodes[i]));
+            for (size_t j = 0; j < nodes.size(); ++j) {
+                int expected = search.get_distance(c.get_index(*nodes[j]));
+                int x = nodes[i]->get_id();
+                int y = nodes[j]->get_id();
+                CHECK_EQUAL(s.distance(x, y), expected);
+                vector<int> ids;
+                int cost = 0;
+                CHECK(s.get_path(x, y, ids, cost));
+                CHECK_EQUAL(cost, expected);
+                CHECK_EQUAL(ids.front(), x);
+                CHECK_EQUAL(ids.back(), y);
+            }
+        }
+    }
+};
+
+TEST(partitioned_shortest_path, reaped)
+{
+    // Nothing left behind, not even a zombie, once the object is gone
+    auto g = graph::generate_graph(30, 0.1, 0, 20, 3);
+    {
+        partitioned_shortest_path s(*g, 4);
+        CHECK_EQUAL(s.worker_count(), 4u);
+    }
+    CHECK_EQUAL(waitpid(-1, nullptr, WNOHANG), -1);
+    CHECK_EQUAL(errno, ECHILD);
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
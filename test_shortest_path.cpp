@@ -1,5 +1,14 @@
+#include "parallel.hpp"
 #include "shortest_path.hpp"
 
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/CommandLineTestRunner.h"
 
@@ -9,8 +18,347 @@ TEST_GROUP(shortest_path)
 
 TEST(shortest_path, linear)
 {
+    // a <-2-> b <-2-> c <-2-> d    e
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    auto& e = g.add_node();
+    g.add_edge(a, b, 2);
+    g.add_edge(b, c, 2);
+    g.add_edge(c, d, 2);
+    shortest_path s(g);
+    CHECK(s.get_backend() == shortest_path::backend::bfs);
+    path* p = s.get_path(a, d);
+    CHECK(p != nullptr);
+    CHECK(p->get_node() == d);
+    CHECK_EQUAL(p->get_cost(), 6);
+    CHECK(p->get_predecessor()->get_node() == c);
+    CHECK(s.get_path(a, e) == nullptr);
+    CHECK_EQUAL(s.get_path(c, c)->get_cost(), 0);
+};
+
+TEST(shortest_path, backend)
+{
+    // a <-1-> b <-1-> c
+    //  \_______5_____/
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 1);
+    g.add_edge(a, c, 5);
+    shortest_path s(g);
+    CHECK(s.get_backend() == shortest_path::backend::dijkstra);
+    CHECK_EQUAL(s.get_path(a, c)->get_cost(), 2);
+    CHECK(s.get_path(a, c)->get_predecessor()->get_node() == b);
 };
 
+TEST(shortest_path, uniform)
+{
+    // Both backends agree on unit weight graphs
+    auto g = graph::generate_graph(60, 0.05, 1, 2);
+    shortest_path fast(*g);
+    shortest_path slow(*g, shortest_path::backend::dijkstra);
+    CHECK(fast.get_backend() == shortest_path::backend::bfs);
+    for (auto& n1: g->get_nodes()) {
+        for (auto& n2: g->get_nodes()) {
+            path* p1 = fast.get_path(*n1, *n2);
+            path* p2 = slow.get_path(*n1, *n2);
+            CHECK_EQUAL(p1 == nullptr, p2 == nullptr);
+            if (p1 && p2) {
+                CHECK_EQUAL(p1->get_cost(), p2->get_cost());
+            }
+        }
+    }
+};
+
+TEST(shortest_path, components)
+{
+    // a <-1-> b <-4-> c    d <-2-> e    f
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    auto& e = g.add_node();
+    auto& f = g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 4);
+    g.add_edge(d, e, 2);
+    shortest_path s(g);
+    CHECK_EQUAL(s.get_path(a, c)->get_cost(), 5);
+    CHECK_EQUAL(s.get_path(e, d)->get_cost(), 2);
+    CHECK(s.get_path(a, d) == nullptr);
+    CHECK(s.get_path(f, a) == nullptr);
+    CHECK(s.get_path(f, f) != nullptr);
+    CHECK_EQUAL(s.get_path(f, f)->get_cost(), 0);
+};
+
+TEST(shortest_path, delta_stepping)
+{
+    auto g = graph::generate_graph(60, 0.05, 0, 20, 11);
+    shortest_path fast(*g, shortest_path::backend::delta_stepping);
+    shortest_path slow(*g, shortest_path::backend::dijkstra);
+    for (auto& n1: g->get_nodes()) {
+        for (auto& n2: g->get_nodes()) {
+            path* p1 = fast.get_path(*n1, *n2);
+            path* p2 = slow.get_path(*n1, *n2);
+            CHECK_EQUAL(p1 == nullptr, p2 == nullptr);
+            if (p1 && p2) {
+                CHECK_EQUAL(p1->get_cost(), p2->get_cost());
+            }
+        }
+    }
+};
+
+TEST(shortest_path, negative)
+{
+    // Instead of Dijkstra's wrong answers we now hear about the
+    // negative cycle, whatever the backend
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    g.add_edge(a, b, 2);
+    g.add_edge(b, c, -1);
+    CHECK_THROWS(runtime_error, shortest_path s(g));
+    CHECK_THROWS(runtime_error, shortest_path s(g, shortest_path::backend::dijkstra, false));
+    CHECK_THROWS(runtime_error, shortest_path s(g, shortest_path::backend::delta_stepping));
+};
+
+TEST(shortest_path, typed)
+{
+    // The same graph with double costs, half of the int ones, and
+    // with unsigned ids: the radix heap and the binary heap kernels
+    // agree with the int backends
+    auto g = graph::generate_graph(60, 0.08, 0, 20, 23);
+    basic_graph<double, int> half;
+    basic_graph<int, uint32_t> wide;
+    vector<basic_graph<double, int>::node*> half_nodes;
+    vector<basic_graph<int, uint32_t>::node*> wide_nodes;
+    vector<graph::node*> nodes;
+    unordered_map<graph::node*, size_t> index;
+    for (auto& n: g->get_nodes()) {
+        index[n.get()] = nodes.size();
+        nodes.push_back(n.get());
+        half_nodes.push_back(&half.add_node());
+        wide_nodes.push_back(&wide.add_node());
+    }
+    for (auto& e: g->get_edges()) {
+        size_t x = index[&e->get_edge().first.get()];
+        size_t y = index[&e->get_edge().second.get()];
+        half.add_edge(*half_nodes[x], *half_nodes[y], e->get_cost() / 2.0);
+        wide.add_edge(*wide_nodes[x], *wide_nodes[y], e->get_cost());
+    }
+    shortest_path s(*g);
+    basic_shortest_path<double, int> half_paths(half);
+    basic_shortest_path<int, uint32_t> wide_paths(wide);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = 0; j < nodes.size(); ++j) {
+            path* p = s.get_path(*nodes[i], *nodes[j]);
+            auto hp = half_paths.get_path(*half_nodes[i], *half_nodes[j]);
+            auto wp = wide_paths.get_path(*wide_nodes[i], *wide_nodes[j]);
+            CHECK_EQUAL(p == nullptr, hp == nullptr);
+            CHECK_EQUAL(p == nullptr, wp == nullptr);
+            if (p) {
+                DOUBLES_EQUAL(hp->get_cost(), p->get_cost() / 2.0, 1e-9);
+                CHECK_EQUAL(wp->get_cost(), p->get_cost());
+                CHECK_EQUAL(wp->get_node().get_id(), j);
+            }
+        }
+    }
+    // Only dijkstra runs on other cost and id types
+    CHECK(wide_paths.get_backend() == shortest_path_backend::dijkstra);
+    typedef basic_shortest_path<int, uint32_t> wide_shortest_path;
+    CHECK_THROWS(runtime_error, wide_shortest_path hops(wide, shortest_path_backend::bfs));
+    half.add_edge(*half_nodes[0], *half_nodes[1], -0.5);
+    typedef basic_shortest_path<double, int> half_shortest_path;
+    CHECK_THROWS(runtime_error, half_shortest_path negative(half));
+};
+
+TEST(shortest_path, stats)
+{
+    // a <-1-> b <-1-> c
+    //  \_______5_____/
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 1);
+    g.add_edge(a, c, 5);
+    shortest_path s(g);
+    auto st = s.get_stats();
+#ifdef SHORTEST_PATH_STATS
+    // Every source settles the three nodes and scans their six arcs
+    CHECK_EQUAL(st.nodes_settled, 9);
+    CHECK_EQUAL(st.edges_relaxed, 18);
+    // From a, c is first reached through the expensive edge
+    CHECK(st.decrease_keys >= 1);
+    CHECK_EQUAL(st.heap_pushes, st.heap_pops);
+    CHECK(st.peak_open_set >= 2);
+    CHECK(st.bytes_allocated > 0);
+    CHECK_EQUAL(st.source_seconds.size(), 3);
+    CHECK(st.total_seconds > 0.0);
+#else
+    CHECK_EQUAL(st.nodes_settled, 0);
+    CHECK_EQUAL(st.source_seconds.size(), 0);
+#endif
+};
+
+TEST(shortest_path, async)
+{
+    // a <-1-> b <-4-> c    d <-2-> e    f
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    auto& e = g.add_node();
+    auto& f = g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 4);
+    g.add_edge(d, e, 2);
+    shortest_path s(g, shortest_path::backend::automatic, false, 2);
+    auto p1 = s.async_get_path(a, c);
+    auto p2 = s.async_get_path(a, b);
+    auto p3 = s.async_get_path(a, d);
+    auto p4 = s.async_get_path(f, f);
+    CHECK_EQUAL(p1.get()->get_cost(), 5);
+    CHECK_EQUAL(p2.get()->get_cost(), 1);
+    CHECK(p3.get() == nullptr);
+    CHECK_EQUAL(p4.get()->get_cost(), 0);
+    // The blocking interface goes through the same tables
+    CHECK_EQUAL(s.get_path(e, d)->get_cost(), 2);
+    CHECK(s.get_path(a, c) == s.async_get_path(a, c).get());
+    // Precomputed tables answer straight away
+    shortest_path eager(g);
+    CHECK_EQUAL(eager.async_get_path(c, a).get()->get_cost(), 5);
+};
+
+TEST(shortest_path, lazy_single_thread)
+{
+    // The executor already runs max_in_flight searches at once, each
+    // of them must stay on its own thread
+    auto g = graph::generate_graph(200, 0.05, 1, 50, 6);
+    shortest_path lazy(*g, shortest_path::backend::delta_stepping, false, 2);
+    auto& n1 = *g->get_nodes().front();
+    auto& n2 = *g->get_nodes().back();
+    lazy.get_path(n1, n2);
+    lazy.get_path(n2, n1);
+    shortest_path eager(*g, shortest_path::backend::delta_stepping);
+#ifdef SHORTEST_PATH_STATS
+    CHECK_EQUAL(lazy.get_stats().peak_threads, 1u);
+    CHECK_EQUAL(eager.get_stats().peak_threads, default_threads());
+#else
+    CHECK_EQUAL(lazy.get_stats().peak_threads, 0u);
+    CHECK_EQUAL(eager.get_stats().peak_threads, 0u);
+#endif
+};
+
+TEST(shortest_path, stats_concurrent)
+{
+    // Reading the stats while lazy searches add to them
+    auto g = graph::generate_graph(80, 0.05, 1, 20, 9);
+    shortest_path lazy(*g, shortest_path::backend::dijkstra, false, 2);
+    vector<future<path*>> pending;
+    for (auto& n: g->get_nodes()) {
+        pending.push_back(lazy.async_get_path(*n, *g->get_nodes().front()));
+    }
+    size_t seen = 0;
+    for (auto& p: pending) {
+        auto st = lazy.get_stats();
+        CHECK(st.source_seconds.size() >= seen);
+        seen = st.source_seconds.size();
+        p.get();
+    }
+#ifdef SHORTEST_PATH_STATS
+    CHECK_EQUAL(lazy.get_stats().source_seconds.size(), g->node_count());
+#else
+    CHECK_EQUAL(lazy.get_stats().source_seconds.size(), 0u);
+#endif
+};
+
+TEST(shortest_path, async_concurrent)
+{
+    // Requests for the same source share one search so they
+    // all point into the same table
+    auto g = graph::generate_graph(80, 0.05, 1, 10, 7);
+    vector<graph::node*> nodes;
+    for (auto& n: g->get_nodes()) {
+        nodes.push_back(n.get());
+    }
+    shortest_path lazy(*g, shortest_path::backend::automatic, false, 4);
+    shortest_path eager(*g);
+    vector<thread> clients;
+    vector<vector<path*>> results(4);
+    for (size_t t = 0; t < results.size(); ++t) {
+        clients.push_back(thread([&, t]()
+        {
+            vector<future<path*>> pending;
+            for (auto n2: nodes) {
+                pending.push_back(lazy.async_get_path(*nodes[t % 2], *n2));
+            }
+            for (auto& p: pending) {
+                results[t].push_back(p.get());
+            }
+        }));
+    }
+    for (auto& t: clients) {
+        t.join();
+    }
+    for (size_t t = 0; t < results.size(); ++t) {
+        CHECK(results[t] == results[t % 2]);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            path* expected = eager.get_path(*nodes[t % 2], *nodes[i]);
+            CHECK_EQUAL(results[t][i] == nullptr, expected == nullptr);
+            if (expected) {
+                CHECK_EQUAL(results[t][i]->get_cost(), expected->get_cost());
+            }
+        }
+    }
+};
+
+TEST(shortest_path, eager_concurrent)
+{
+    // a <-1-> b    c <-1-> d
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(c, d, 1);
+    shortest_path s(g);
+    // The tables answer, not the graph: an edge added afterwards does
+    // not join the components and a new node has no path at all
+    g.add_edge(b, c, 1);
+    auto& e = g.add_node();
+    CHECK(s.get_path(a, b) != nullptr);
+    CHECK(s.get_path(a, d) == nullptr);
+    CHECK(s.get_path(a, e) == nullptr);
+    // Readers on several threads never touch the graph
+    vector<thread> clients;
+    vector<size_t> found(4, 0);
+    for (size_t t = 0; t < found.size(); ++t) {
+        clients.push_back(thread([&, t]()
+        {
+            for (size_t i = 0; i < 1000; ++i) {
+                found[t] += s.async_get_path(a, b).get() != nullptr;
+                found[t] += s.get_path(c, a) != nullptr;
+            }
+        }));
+    }
+    for (auto& t: clients) {
+        t.join();
+    }
+    for (auto f: found) {
+        CHECK_EQUAL(f, 1000u);
+    }
+};
 
 int main(int ac, char ** av)
 {
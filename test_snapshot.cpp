@@ -0,0 +1,129 @@
+#include "snapshot.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(snapshot)
+{
+};
+
+TEST(snapshot, query)
+{
+    // 0 <-1-> 1 <-1-> 2 <-5-> 3
+    //  \_________3_________/
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    g.add_edge(a, b, 1);
+    g.add_edge(b, c, 1);
+    g.add_edge(c, d, 5);
+    g.add_edge(a, d, 3);
+    graph_snapshot s(g, 7);
+    // Later changes to the graph do not leak into the snapshot
+    g.delete_node(d);
+    CHECK_EQUAL(s.get_version(), 7);
+    CHECK_EQUAL(s.node_count(), 4);
+    CHECK_EQUAL(s.edge_count(), 4);
+    CHECK(s.has_node(3));
+    CHECK(!s.has_node(4));
+    CHECK(s.adjacent(0, 3));
+    CHECK(s.adjacent(2, 1));
+    CHECK(!s.adjacent(0, 2));
+    vector<int> ids;
+    int cost = 0;
+    CHECK(s.get_path(2, 3, ids, cost));
+    CHECK_EQUAL(cost, 5);
+    CHECK(ids == vector<int>({2, 3}));
+    CHECK(s.get_path(1, 3, ids, cost));
+    CHECK_EQUAL(cost, 4);
+    CHECK(ids == vector<int>({1, 0, 3}));
+    CHECK(!s.get_path(1, 42, ids, cost));
+};
+
+TEST(snapshot, versions)
+{
+    versioned_graph vg;
+    auto r = vg.get_reader();
+    CHECK_EQUAL(vg.get_version(), 1);
+    {
+        auto p = r.get_pin();
+        CHECK_EQUAL(p->node_count(), 0);
+        vg.update([](graph& g) {g.add_edge(g.add_node(), g.add_node(), 2);});
+        // Still pinned on the first version which cannot be reclaimed yet
+        CHECK_EQUAL(p->get_version(), 1);
+        CHECK_EQUAL(p->node_count(), 0);
+        CHECK_EQUAL(vg.retired_count(), 1);
+        auto p2 = r.get_pin();
+        CHECK_EQUAL(p2->get_version(), 2);
+        CHECK(p2->adjacent(0, 1));
+    }
+    CHECK_EQUAL(vg.retired_count(), 0);
+    auto p = r.get_pin();
+    CHECK_EQUAL(p->edge_count(), 1);
+};
+
+TEST(snapshot, readers)
+{
+    versioned_graph vg(2);
+    auto r1 = vg.get_reader();
+    {
+        auto r2 = vg.get_reader();
+        CHECK_THROWS(runtime_error, vg.get_reader());
+    }
+    // The slot of r2 is free again
+    auto r3 = vg.get_reader();
+};
+
+TEST(snapshot, concurrent)
+{
+    // The writer grows a chain, every version a reader pins must
+    // be a complete chain whatever the writer is doing meanwhile
+    versioned_graph vg;
+    vg.update([](graph& g) {g.add_node();});
+    atomic<bool> done(false);
+    atomic<size_t> broken(0);
+    vector<thread> readers;
+    for (size_t t = 0; t < 4; ++t) {
+        readers.push_back(thread([&]()
+        {
+            auto r = vg.get_reader();
+            vector<int> ids;
+            int cost = 0;
+            while (!done) {
+                auto p = r.get_pin();
+                int last = static_cast<int>(p->node_count()) - 1;
+                if (!p->get_path(0, last, ids, cost) || cost != last) {
+                    ++broken;
+                }
+            }
+        }));
+    }
+    for (int i = 1; i < 200; ++i) {
+        vg.update([&](graph& g)
+        {
+            auto& previous = *g.get_nodes().back();
+            g.add_edge(previous, g.add_node(i), 1);
+        });
+    }
+    done = true;
+    for (auto& t: readers) {
+        t.join();
+    }
+    CHECK_EQUAL(broken, 0);
+    CHECK_EQUAL(vg.get_version(), 201);
+    CHECK_EQUAL(vg.retired_count(), 0);
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,113 @@
+#include "graph.hpp"
+#include "spanning_forest.hpp"
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(spanning_forest)
+{
+};
+
+// Kruskal with a plain union-find to compare with
+static int kruskal(graph& g)
+{
+    unordered_map<graph::node*, graph::node*> parent;
+    for (auto& n: g.get_nodes()) {
+        parent[n.get()] = n.get();
+    }
+    auto find = [&](graph::node* x)
+    {
+        while (parent[x] != x) {
+            x = parent[x];
+        }
+        return x;
+    };
+    vector<graph::edge*> edges;
+    for (auto& e: g.get_edges()) {
+        edges.push_back(e.get());
+    }
+    stable_sort(edges.begin(), edges.end(), [](graph::edge* e1, graph::edge* e2)
+    {
+        return e1->get_cost() < e2->get_cost();
+    });
+    int total = 0;
+    for (auto e: edges) {
+        auto x = find(&e->get_edge().first.get());
+        auto y = find(&e->get_edge().second.get());
+        if (x != y) {
+            parent[x] = y;
+            total += e->get_cost();
+        }
+    }
+    return total;
+}
+
+TEST(spanning_forest, empty)
+{
+    graph g;
+    CHECK(minimum_spanning_forest(g).empty());
+    g.add_node();
+    CHECK(minimum_spanning_forest(g).empty());
+};
+
+TEST(spanning_forest, triangle)
+{
+    // a <-3-> b <-1-> c <-2-> a    d <-5-> e
+    graph g;
+    auto& a = g.add_node();
+    auto& b = g.add_node();
+    auto& c = g.add_node();
+    auto& d = g.add_node();
+    auto& e = g.add_node();
+    g.add_edge(a, b, 3);
+    g.add_edge(b, c, 1);
+    auto& ca = g.add_edge(c, a, 2);
+    auto& de = g.add_edge(d, e, 5);
+    auto forest = minimum_spanning_forest(g);
+    CHECK_EQUAL(forest.size(), 3);
+    auto iter = forest.begin();
+    CHECK((iter++)->get().is_edge(b, c));
+    CHECK(&(iter++)->get() == &ca);
+    CHECK(&(iter++)->get() == &de);
+};
+
+TEST(spanning_forest, kruskal)
+{
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        // Negative costs are fine, only the order of the costs matters
+        auto g = graph::generate_graph(300, 0.02, -20, 20, seed);
+        int expected = kruskal(*g);
+        for (size_t threads: {1, 4}) {
+            auto forest = minimum_spanning_forest(*g, threads);
+            int total = 0;
+            for (auto& e: forest) {
+                total += e.get().get_cost();
+            }
+            CHECK_EQUAL(total, expected);
+            CHECK_EQUAL(forest.size(), g->node_count() - g->component_count());
+        }
+    }
+};
+
+TEST(spanning_forest, deterministic)
+{
+    // Every cost the same, only the tie breaking decides
+    auto g = graph::generate_graph(3000, 0.01, 1, 2, 9);
+    auto one = minimum_spanning_forest(*g, 1);
+    auto many = minimum_spanning_forest(*g, 8);
+    CHECK_EQUAL(one.size(), many.size());
+    CHECK(equal(one.begin(), one.end(), many.begin(),
+                [](graph::edge_ref e1, graph::edge_ref e2) {return &e1.get() == &e2.get();}));
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
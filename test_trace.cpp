@@ -0,0 +1,145 @@
+#include "graph.hpp"
+#include "shortest_path.hpp"
+#include "trace.hpp"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(trace)
+{
+};
+
+static size_t occurrences(const string& s, const string& what)
+{
+    size_t count = 0;
+    for (auto i = s.find(what); i != string::npos; i = s.find(what, i + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+TEST(trace, shortest_path)
+{
+    trace_clear();
+    auto g = graph::generate_graph(20, 0.2, 1, 10, 4);
+    shortest_path s(*g, shortest_path::backend::dijkstra);
+    auto& n = *g->get_nodes().front();
+    s.get_path(n, n);
+    ostringstream out;
+    size_t count = trace_write(out);
+    string json = out.str();
+    CHECK_EQUAL(json.find("{\"traceEvents\":["), 0u);
+    CHECK(json.find("\"displayTimeUnit\":\"ns\"}") != string::npos);
+#ifdef SHORTEST_PATH_TRACE
+    CHECK_EQUAL(occurrences(json, "\"name\":\"generate_graph\""), 1u);
+    CHECK_EQUAL(occurrences(json, "\"name\":\"compute_paths\""), 1u);
+    CHECK_EQUAL(occurrences(json, "\"name\":\"get_path\""), 1u);
+    // At least the whole graph, then a snapshot of each component
+    CHECK(occurrences(json, "\"name\":\"csr\"") >= 1u);
+    CHECK_EQUAL(occurrences(json, "\"name\":\"search\""), g->node_count());
+    CHECK_EQUAL(occurrences(json, "\"ph\":\"X\""), count);
+    CHECK(json.find("\"args\":{\"value\":") != string::npos);
+#else
+    CHECK_EQUAL(count, 0u);
+    CHECK_EQUAL(occurrences(json, "\"name\""), 0u);
+#endif
+};
+
+TEST(trace, threads)
+{
+    trace_clear();
+    TRACE_SPAN("main");
+    thread t([]() {TRACE_SPAN_VALUE("worker", 7);});
+    t.join();
+    ostringstream out;
+    size_t count = trace_write(out);
+    string json = out.str();
+#ifdef SHORTEST_PATH_TRACE
+    // The span of main is still open, the one of the thread is done
+    CHECK_EQUAL(count, 1u);
+    CHECK(json.find("\"name\":\"worker\"") != string::npos);
+    CHECK(json.find("\"args\":{\"value\":7}") != string::npos);
+#else
+    CHECK_EQUAL(count, 0u);
+#endif
+};
+
+TEST(trace, ring)
+{
+    trace_clear();
+    // Only the last spans are kept
+    for (size_t i = 0; i < trace_capacity + 10; ++i) {
+        TRACE_SPAN_VALUE("span", i);
+    }
+    ostringstream out;
+    size_t count = trace_write(out);
+#ifdef SHORTEST_PATH_TRACE
+    CHECK_EQUAL(count, trace_capacity);
+    string json = out.str();
+    CHECK(json.find("\"args\":{\"value\":9}") == string::npos);
+    CHECK(json.find("\"args\":{\"value\":10}") != string::npos);
+#else
+    CHECK_EQUAL(count, 0u);
+#endif
+};
+
+TEST(trace, reuse)
+{
+    trace_clear();
+    // One thread after the other, they all record in the same buffer
+    // but every span keeps the number of its own thread
+    const size_t threads = 20;
+    for (size_t i = 0; i < threads; ++i) {
+        thread t([i]() {TRACE_SPAN_VALUE("worker", i);});
+        t.join();
+    }
+    ostringstream out;
+    size_t count = trace_write(out);
+#ifdef SHORTEST_PATH_TRACE
+    CHECK_EQUAL(count, threads);
+    string json = out.str();
+    set<string> tids;
+    for (auto i = json.find("\"tid\":"); i != string::npos; i = json.find("\"tid\":", i + 1)) {
+        tids.insert(json.substr(i, json.find(',', i) - i));
+    }
+    CHECK_EQUAL(tids.size(), threads);
+#else
+    CHECK_EQUAL(count, 0u);
+#endif
+};
+
+TEST(trace, clear_from_thread)
+{
+    trace_clear();
+    {
+        TRACE_SPAN("before");
+    }
+    // Cleared by another thread than the one that records
+    thread t([]() {trace_clear();});
+    t.join();
+    {
+        TRACE_SPAN("after");
+    }
+    ostringstream out;
+    size_t count = trace_write(out);
+#ifdef SHORTEST_PATH_TRACE
+    CHECK_EQUAL(count, 1u);
+    string json = out.str();
+    CHECK(json.find("\"name\":\"before\"") == string::npos);
+    CHECK(json.find("\"name\":\"after\"") != string::npos);
+#else
+    CHECK_EQUAL(count, 0u);
+#endif
+};
+
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -0,0 +1,181 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>       // For unique_ptr
+#include <mutex>
+#include <vector>
+
+// C includes
+#include <ctime>        // For clock_gettime
+#include <unistd.h>     // For getpid
+
+using namespace std;
+
+namespace {
+
+// One per thread recording spans at the same time. They are never
+// freed but handed over from a thread that exits to the next one, the
+// spans of threads that are gone can still be written out.
+struct trace_buffer
+{
+    vector<trace_event> events;
+    // Spans ever recorded, the last one is at (written - 1) % capacity.
+    // Only the thread that owns the buffer stores to it.
+    atomic<uint64_t> written;
+    // Spans before this one were cleared. Stored by trace_clear under
+    // the registry lock, so that it never stores to written itself.
+    atomic<uint64_t> cleared_at;
+    // Owner, set under the registry lock when the buffer changes hands
+    uint32_t thread;
+    trace_buffer() : events(trace_capacity), written(0), cleared_at(0), thread(0) {}
+};
+
+struct trace_registry
+{
+    mutex lock;
+    vector<unique_ptr<trace_buffer>> buffers;
+    // Buffers of the threads that exited
+    vector<trace_buffer*> free;
+    uint32_t threads; // Ever recorded
+    trace_registry() : lock(), buffers(), free(), threads(0) {}
+};
+
+trace_registry& registry()
+{
+    // Leaked on purpose, threads may still record during exit
+    static trace_registry* r = new trace_registry();
+    return *r;
+}
+
+#ifdef SHORTEST_PATH_TRACE
+
+// Buffer of the calling thread, trivially destructible so that spans
+// recorded by other thread_local destructors can still find it
+thread_local trace_buffer* current = nullptr;
+
+// Hands the buffer back when the thread exits
+struct buffer_holder
+{
+    ~buffer_holder()
+    {
+        auto& r = registry();
+        lock_guard<mutex> lock(r.lock);
+        if (current) {
+            r.free.push_back(current);
+        }
+        // A span recorded after this takes a buffer that it never
+        // gives back, like every buffer used to
+        current = nullptr;
+    }
+};
+
+trace_buffer& thread_buffer()
+{
+    // The lock is only taken the first time a thread records
+    if (!current) {
+        static thread_local buffer_holder holder;
+        (void)holder;
+        auto& r = registry();
+        lock_guard<mutex> lock(r.lock);
+        if (r.free.empty()) {
+            r.buffers.push_back(unique_ptr<trace_buffer>(new trace_buffer()));
+            current = r.buffers.back().get();
+        } else {
+            current = r.free.back();
+            r.free.pop_back();
+        }
+        current->thread = ++r.threads;
+    }
+    return *current;
+}
+
+#endif // SHORTEST_PATH_TRACE
+
+void write_name(ostream& out, const char* name)
+{
+    out << '"';
+    for (; *name; ++name) {
+        if (*name == '"' || *name == '\\') {
+            out << '\\';
+        }
+        out << *name;
+    }
+    out << '"';
+}
+
+// Nanoseconds as microseconds without going through a double, which
+// would round the timestamps of a machine that is up for long
+void write_micros(ostream& out, uint64_t ns)
+{
+    out << ns / 1000 << '.' << setw(3) << setfill('0') << ns % 1000;
+}
+
+}
+
+#ifdef SHORTEST_PATH_TRACE
+
+uint64_t trace_now()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+void trace_record(const trace_event& e)
+{
+    auto& b = thread_buffer();
+    uint64_t w = b.written.load(memory_order_relaxed);
+    trace_event& slot = b.events[w % trace_capacity];
+    slot = e;
+    slot.thread = b.thread;
+    // Publishes the event to trace_write
+    b.written.store(w + 1, memory_order_release);
+}
+
+#endif // SHORTEST_PATH_TRACE
+
+size_t trace_write(ostream& out)
+{
+    auto& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    auto fill = out.fill();
+    out << "{\"traceEvents\":[";
+    size_t count = 0;
+    long pid = getpid();
+    for (auto& b: r.buffers) {
+        uint64_t written = b->written.load(memory_order_acquire);
+        uint64_t first = written > trace_capacity ? written - trace_capacity : 0;
+        first = max(first, b->cleared_at.load(memory_order_relaxed));
+        for (uint64_t i = first; i < written; ++i) {
+            const trace_event& e = b->events[i % trace_capacity];
+            // Complete events, timestamps in microseconds
+            out << (count++ ? ",\n" : "\n") << "{\"name\":";
+            write_name(out, e.name);
+            out << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << e.thread
+                << ",\"ts\":";
+            write_micros(out, e.begin);
+            out << ",\"dur\":";
+            write_micros(out, e.end - e.begin);
+            if (e.has_value) {
+                out << ",\"args\":{\"value\":" << e.value << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    out.fill(fill);
+    return count;
+}
+
+void trace_clear()
+{
+    auto& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    // Only the owner of a buffer stores to written, so a clear from
+    // another thread moves the start of the spans up instead
+    for (auto& b: r.buffers) {
+        b->cleared_at.store(b->written.load(memory_order_acquire), memory_order_relaxed);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef __TRACE__
+#define __TRACE__
+
+// C++ includes
+#include <iostream>
+
+// C includes
+#include <cstddef>      // For size_t
+#include <cstdint>      // For uint64_t
+
+// Spans of time spent in the graph and search code, written out in
+// the Chrome trace event format (chrome://tracing, Perfetto).
+//
+// Like the counters of stats.hpp they only exist when the code is
+// built with -DSHORTEST_PATH_TRACE, the TRACE_* macros expand to
+// nothing otherwise. When enabled a span is two clock reads and one
+// store in a ring buffer of its own thread, no lock and no shared
+// cache line. Every buffer keeps the last trace_capacity spans of its
+// thread, older ones are overwritten. When a thread exits its buffer
+// goes to the next thread that starts recording, so there are only as
+// many buffers as threads recording at the same time; the spans left
+// in it keep the number of the thread that recorded them until they
+// are overwritten. Span names must be string literals, only the
+// pointer is kept.
+//
+// The clock is CLOCK_MONOTONIC, the one `perf record -k mono` stamps
+// its samples with, so perf samples can be matched against the spans
+// they fall in.
+struct trace_event
+{
+    const char* name;
+    long value;         // Shown as args.value when has_value
+    bool has_value;
+    uint32_t thread;    // Set by trace_record, fits in the padding
+    uint64_t begin;     // Nanoseconds
+    uint64_t end;
+};
+
+static const size_t trace_capacity = 1 << 16;
+
+// Every span still in the buffers as one JSON trace, returns how many
+// there are. Spans recorded while writing may or may not make it and
+// may even come out garbled, call it when the work to look at is
+// over. Without -DSHORTEST_PATH_TRACE it writes an empty trace.
+size_t trace_write(std::ostream& out);
+// Forget every span recorded so far. Safe to call while other threads
+// record, which the spans they record meanwhile survive or not.
+void trace_clear();
+
+#ifdef SHORTEST_PATH_TRACE
+
+uint64_t trace_now();
+void trace_record(const trace_event& e);
+
+class trace_span
+{
+    public:
+        explicit trace_span(const char* name)
+            : _event{name, 0, false, 0, trace_now(), 0} {}
+        trace_span(const char* name, long value)
+            : _event{name, value, true, 0, trace_now(), 0} {}
+        ~trace_span()
+        {
+            _event.end = trace_now();
+            trace_record(_event);
+        }
+        trace_span(const trace_span&) = delete;
+        trace_span& operator=(const trace_span&) = delete;
+    private:
+        trace_event _event;
+};
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+// Span from here to the end of the enclosing scope
+#define TRACE_SPAN(name) trace_span TRACE_JOIN(trace_span_, __LINE__)(name)
+// Same with a number attached, a node id for instance
+#define TRACE_SPAN_VALUE(name, value) \
+    trace_span TRACE_JOIN(trace_span_, __LINE__)(name, static_cast<long>(value))
+
+#else
+
+#define TRACE_SPAN(name) ((void)0)
+#define TRACE_SPAN_VALUE(name, value) ((void)0)
+
+#endif // SHORTEST_PATH_TRACE
+
+#endif // __TRACE__